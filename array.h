@@ -0,0 +1,192 @@
+#ifndef ARRAY_H
+#define ARRAY_H
+
+#include <stdlib.h> //qsort, bsearch
+#include <string.h>
+#include <assert.h>
+#include "memory.h"
+
+/*
+growable array with the same hidden header trick as heap_string, the array is a plain pointer to the elements
+and NULL is an empty array. the macros may evaluate the array argument more than once.
+
+struct vec3 *points = NULL;
+array_reserve(points, 1024);
+array_push(points, v);
+for(size_t i = 0; i < array_size(points); ++i)
+	points[i].x += 1.f;
+array_sort(points, compare_vec3);
+array_free(points); //points is NULL again
+
+elements move when the array grows, don't keep pointers into it across a push/insert/reserve.
+*/
+
+union array_header
+{
+	struct
+	{
+		size_t capacity;
+		size_t size;
+		size_t element_size;
+		void *custom_allocator_userptr;
+		custom_allocator_fn_t custom_allocator_fn;
+		size_t insert_index; //so array_insert evaluates its index once, before the size changes
+	} info;
+	//keep the elements after the header aligned like malloc's
+	long double align_ld;
+	long long align_ll;
+	void *align_p;
+};
+
+#define ARRAY_HDR(a) ((union array_header*)(a) - 1)
+#define ARRAY_MIN_CAPACITY (8)
+
+typedef int (*array_compare_fn_t)(const void*, const void*);
+
+#ifndef ARRAY_IMPL
+//returns a with room for at least additional more elements
+extern void *array_grow_(void *a, size_t element_size, size_t additional);
+extern void *array_insert_(void *a, size_t element_size, size_t index, size_t n);
+extern void *array_append_(void *a, size_t element_size, const void *items, size_t n);
+extern void array_erase_(void *a, size_t index, size_t n);
+extern void *array_init_with_custom_allocator_(size_t element_size, size_t capacity, void *userptr, custom_allocator_fn_t allocator_fn);
+//index of the first element that doesn't compare less than key, array_size(a) if there's none
+extern size_t array_lower_bound_(const void *a, const void *key, array_compare_fn_t cmp);
+#else
+
+static void *array_allocate(void *userptr, custom_allocator_fn_t allocator_fn, size_t nbytes)
+{
+	if(allocator_fn && userptr)
+		return allocator_fn(userptr, nbytes);
+	return memory_allocate(nbytes);
+}
+
+void *array_init_with_custom_allocator_(size_t element_size, size_t capacity, void *userptr, custom_allocator_fn_t allocator_fn)
+{
+	union array_header *hdr = array_allocate(userptr, allocator_fn, sizeof(union array_header) + element_size * capacity);
+	hdr->info.capacity = capacity;
+	hdr->info.size = 0;
+	hdr->info.element_size = element_size;
+	hdr->info.custom_allocator_userptr = userptr;
+	hdr->info.custom_allocator_fn = allocator_fn;
+	return hdr + 1;
+}
+
+void *array_grow_(void *a, size_t element_size, size_t additional)
+{
+	if(!a)
+	{
+		size_t capacity = additional > ARRAY_MIN_CAPACITY ? additional : ARRAY_MIN_CAPACITY;
+		return array_init_with_custom_allocator_(element_size, capacity, NULL, NULL);
+	}
+	union array_header *hdr = ARRAY_HDR(a);
+	assert(hdr->info.element_size == element_size);
+	size_t needed = hdr->info.size + additional;
+	if(needed <= hdr->info.capacity)
+		return a;
+
+	//doubling keeps push amortized O(1)
+	size_t capacity = hdr->info.capacity * 2;
+	if(capacity < needed)
+		capacity = needed;
+	if(capacity < ARRAY_MIN_CAPACITY)
+		capacity = ARRAY_MIN_CAPACITY;
+	void *b = array_init_with_custom_allocator_(element_size, capacity, hdr->info.custom_allocator_userptr, hdr->info.custom_allocator_fn);
+	memcpy(b, a, hdr->info.size * element_size);
+	ARRAY_HDR(b)->info.size = hdr->info.size;
+	memory_deallocate(hdr);
+	return b;
+}
+
+void *array_insert_(void *a, size_t element_size, size_t index, size_t n)
+{
+	a = array_grow_(a, element_size, n);
+	union array_header *hdr = ARRAY_HDR(a);
+	assert(index <= hdr->info.size);
+	unsigned char *p = (unsigned char*)a + index * element_size;
+	memmove(p + n * element_size, p, (hdr->info.size - index) * element_size);
+	hdr->info.size += n;
+	hdr->info.insert_index = index;
+	return a;
+}
+
+void *array_append_(void *a, size_t element_size, const void *items, size_t n)
+{
+	if(!n)
+		return a;
+	a = array_grow_(a, element_size, n);
+	union array_header *hdr = ARRAY_HDR(a);
+	memcpy((unsigned char*)a + hdr->info.size * element_size, items, n * element_size);
+	hdr->info.size += n;
+	return a;
+}
+
+void array_erase_(void *a, size_t index, size_t n)
+{
+	union array_header *hdr = ARRAY_HDR(a);
+	assert(index + n <= hdr->info.size);
+	size_t element_size = hdr->info.element_size;
+	unsigned char *p = (unsigned char*)a + index * element_size;
+	memmove(p, p + n * element_size, (hdr->info.size - index - n) * element_size);
+	hdr->info.size -= n;
+}
+
+size_t array_lower_bound_(const void *a, const void *key, array_compare_fn_t cmp)
+{
+	if(!a)
+		return 0;
+	union array_header *hdr = ARRAY_HDR(a);
+	size_t lo = 0, hi = hdr->info.size;
+	while(lo < hi)
+	{
+		size_t mid = lo + (hi - lo) / 2;
+		if(cmp((const unsigned char*)a + mid * hdr->info.element_size, key) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+#endif
+
+#define array_size(a) ((a) ? ARRAY_HDR(a)->info.size : (size_t)0)
+#define array_capacity(a) ((a) ? ARRAY_HDR(a)->info.capacity : (size_t)0)
+#define array_last(a) ((a)[array_size(a) - 1])
+
+//an empty array whose memory comes from allocator_fn, freed with memory_deallocate like the other containers
+#define array_init_with_custom_allocator(a, capacity, userptr, allocator_fn) \
+	((a) = array_init_with_custom_allocator_(sizeof(*(a)), (capacity), (userptr), (allocator_fn)))
+#define array_reserve(a, n) \
+	((a) = array_grow_((a), sizeof(*(a)), (n) > array_size(a) ? (n) - array_size(a) : 0))
+#define array_free(a) \
+	do { if(a) memory_deallocate(ARRAY_HDR(a)); (a) = NULL; } while(0)
+#define array_clear(a) \
+	do { if(a) ARRAY_HDR(a)->info.size = 0; } while(0)
+//new elements are left uninitialized
+#define array_resize(a, n) \
+	do { array_reserve(a, n); if(a) ARRAY_HDR(a)->info.size = (n); } while(0)
+
+#define array_push(a, value) \
+	((a) = array_grow_((a), sizeof(*(a)), 1), (a)[ARRAY_HDR(a)->info.size++] = (value))
+#define array_pop(a) \
+	(assert(array_size(a) > 0), (a)[--ARRAY_HDR(a)->info.size])
+#define array_append(a, items, n) \
+	((a) = array_append_((a), sizeof(*(a)), (items), (n)))
+#define array_insert(a, index, value) \
+	((a) = array_insert_((a), sizeof(*(a)), (index), 1), (a)[ARRAY_HDR(a)->info.insert_index] = (value))
+#define array_erase(a, index) \
+	array_erase_((a), (index), 1)
+#define array_erase_n(a, index, n) \
+	array_erase_((a), (index), (n))
+//O(1), moves the last element into the hole
+#define array_erase_swap(a, index) \
+	((a)[(index)] = (a)[--ARRAY_HDR(a)->info.size])
+
+#define array_sort(a, cmp) \
+	do { if(a) qsort((a), array_size(a), sizeof(*(a)), (cmp)); } while(0)
+//a has to be sorted by cmp, returns a pointer to the element or NULL
+#define array_bsearch(a, key, cmp) \
+	((a) ? bsearch((key), (a), array_size(a), sizeof(*(a)), (cmp)) : NULL)
+#define array_lower_bound(a, key, cmp) \
+	array_lower_bound_((a), (key), (cmp))
+#endif
@@ -0,0 +1,876 @@
+#ifndef ART_H
+#define ART_H
+
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include "memory.h"
+
+/*
+adaptive radix tree keyed by strings, kept in strcmp order so it answers prefix and range queries hash_map can't.
+values follow the hash_map convention, data_size bytes copied in and on_key_removal_fn called with a pointer to them.
+
+struct art *t = art_create(int);
+art_insert(t, "assets/textures/grass.png", id);
+int *v = art_find(t, "assets/textures/grass.png");
+
+int print(void *userptr, const char *key, void *data) { printf("%s %d\n", key, *(int*)data); return 0; } //non-zero stops
+art_foreach(t, print, NULL); //every key in order
+art_foreach_prefix(t, "assets/textures/", print, NULL);
+art_foreach_range(t, "assets/a", "assets/m", print, NULL); //"assets/a" <= key < "assets/m", NULL for no bound
+
+inner nodes grow and shrink between 4, 16, 48 and 256 children, a chain of single child nodes is collapsed into
+a prefix stored in the node (the first ART_MAX_PREFIX_LENGTH bytes of it, the rest is checked against a leaf).
+keys include their terminating '\0' so no key is a prefix of another. leaves are tagged pointers to one allocation
+holding the key and the value, pointers from find stay valid until the key is removed.
+*/
+
+#define ART_MAX_PREFIX_LENGTH (10)
+
+#define ART_NODE4 (1)
+#define ART_NODE16 (2)
+#define ART_NODE48 (3)
+#define ART_NODE256 (4)
+
+struct art_node
+{
+	uint8_t type;
+	uint16_t num_children;
+	uint32_t prefix_length;
+	unsigned char prefix[ART_MAX_PREFIX_LENGTH];
+};
+
+//keys sorted, searched with sse2 in the 16 child node
+struct art_node4
+{
+	struct art_node n;
+	unsigned char keys[4];
+	struct art_node *children[4];
+};
+
+struct art_node16
+{
+	struct art_node n;
+	unsigned char keys[16];
+	struct art_node *children[16];
+};
+
+//child_index[byte] is the slot in children + 1, 0 for none
+struct art_node48
+{
+	struct art_node n;
+	unsigned char child_index[256];
+	struct art_node *children[48];
+};
+
+struct art_node256
+{
+	struct art_node n;
+	struct art_node *children[256];
+};
+
+#pragma warning( push )
+#pragma warning( disable : 4200 )
+struct art_leaf
+{
+	size_t key_length; //strlen(key)
+	char *key; //after the value in the same allocation
+	unsigned char data[];
+};
+#pragma warning( pop )
+
+struct art
+{
+	struct art_node *root;
+	size_t data_size;
+	size_t num_entries;
+	deallocator_t on_key_removal_fn;
+	void *custom_allocator_userptr;
+	custom_allocator_fn_t custom_allocator_fn;
+};
+
+//return non-zero to stop, the foreach functions return that value (0 if they went through everything)
+typedef int (*art_callback_fn_t)(void *userptr, const char *key, void *data);
+
+#ifndef ART_IMPL
+extern struct art *art_create_data(size_t data_size, void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn);
+extern void art_destroy(struct art **tp);
+extern void art_set_on_key_removal(struct art *t, deallocator_t fn);
+extern void *art_find(struct art *t, const char *key);
+//returns 1 if the key already exists (and doesn't insert), same as hash_map_insert
+extern int art_insert_data(struct art *t, const char *key, unsigned char *data, size_t data_size);
+extern int art_remove_key(struct art *t, const char *key);
+extern int art_foreach(struct art *t, art_callback_fn_t fn, void *userptr);
+extern int art_foreach_prefix(struct art *t, const char *prefix, art_callback_fn_t fn, void *userptr);
+//from <= key < to, either can be NULL
+extern int art_foreach_range(struct art *t, const char *from, const char *to, art_callback_fn_t fn, void *userptr);
+#else
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ART_SSE2
+#endif
+
+#define ART_IS_LEAF(x) (((uintptr_t)(x) & 1) != 0)
+#define ART_LEAF(x) ((struct art_leaf*)((uintptr_t)(x) & ~(uintptr_t)1))
+#define ART_TAG_LEAF(l) ((struct art_node*)((uintptr_t)(l) | 1))
+
+#ifdef ART_SSE2
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static int art_ctz(unsigned int x)
+{
+	#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, x);
+		return (int)index;
+	#else
+		return __builtin_ctz(x);
+	#endif
+}
+#endif
+
+static void *art_allocate(struct art *t, size_t n)
+{
+	if(t->custom_allocator_fn && t->custom_allocator_userptr)
+		return t->custom_allocator_fn(t->custom_allocator_userptr, n);
+	return memory_allocate(n);
+}
+
+struct art *art_create_data(size_t data_size, void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn)
+{
+	struct art *t = NULL;
+	if(custom_allocator_fn && custom_allocator_userptr)
+		t = custom_allocator_fn(custom_allocator_userptr, sizeof(struct art));
+	else
+		t = memory_allocate(sizeof(struct art));
+	t->root = NULL;
+	t->data_size = data_size;
+	t->num_entries = 0;
+	t->on_key_removal_fn = NULL;
+	t->custom_allocator_userptr = custom_allocator_userptr;
+	t->custom_allocator_fn = custom_allocator_fn;
+	return t;
+}
+
+void art_set_on_key_removal(struct art *t, deallocator_t fn)
+{
+	t->on_key_removal_fn = fn;
+}
+
+static struct art_node *art_alloc_node(struct art *t, uint8_t type)
+{
+	static const size_t sizes[] = { 0, sizeof(struct art_node4), sizeof(struct art_node16), sizeof(struct art_node48), sizeof(struct art_node256) };
+	struct art_node *n = art_allocate(t, sizes[type]);
+	memset(n, 0, sizes[type]);
+	n->type = type;
+	return n;
+}
+
+static struct art_leaf *art_alloc_leaf(struct art *t, const char *key, size_t key_length, const unsigned char *data)
+{
+	struct art_leaf *l = art_allocate(t, sizeof(struct art_leaf) + t->data_size + key_length + 1);
+	l->key_length = key_length;
+	l->key = (char*)&l->data[t->data_size];
+	memcpy(l->key, key, key_length + 1);
+	memcpy(l->data, data, t->data_size);
+	return l;
+}
+
+static void art_free_leaf(struct art *t, struct art_leaf *l)
+{
+	if(t->on_key_removal_fn)
+		t->on_key_removal_fn(l->data);
+	memory_deallocate(l);
+}
+
+static void art_free_node(struct art *t, struct art_node *n)
+{
+	if(!n)
+		return;
+	if(ART_IS_LEAF(n))
+	{
+		art_free_leaf(t, ART_LEAF(n));
+		return;
+	}
+	switch(n->type)
+	{
+		case ART_NODE4:
+			for(int i = 0; i < n->num_children; ++i)
+				art_free_node(t, ((struct art_node4*)n)->children[i]);
+			break;
+		case ART_NODE16:
+			for(int i = 0; i < n->num_children; ++i)
+				art_free_node(t, ((struct art_node16*)n)->children[i]);
+			break;
+		case ART_NODE48:
+			for(int i = 0; i < 48; ++i)
+				art_free_node(t, ((struct art_node48*)n)->children[i]);
+			break;
+		case ART_NODE256:
+			for(int i = 0; i < 256; ++i)
+				art_free_node(t, ((struct art_node256*)n)->children[i]);
+			break;
+	}
+	memory_deallocate(n);
+}
+
+void art_destroy(struct art **tp)
+{
+	struct art *t = *tp;
+	if(!t)
+		return;
+	art_free_node(t, t->root);
+	memory_deallocate(t);
+	*tp = NULL;
+}
+
+//index of the first key greater than c among the n sorted keys
+static int art_node16_lower_bound(const struct art_node16 *node, unsigned char c)
+{
+	#ifdef ART_SSE2
+		//no unsigned byte compare in sse2, flipping the sign bit makes the signed one order like unsigned
+		__m128i bias = _mm_set1_epi8((char)0x80);
+		__m128i greater = _mm_cmplt_epi8(_mm_xor_si128(_mm_set1_epi8((char)c), bias), _mm_xor_si128(_mm_loadu_si128((const __m128i*)node->keys), bias));
+		unsigned int mask = (unsigned int)_mm_movemask_epi8(greater) & ((1u << node->n.num_children) - 1);
+		return mask ? art_ctz(mask) : node->n.num_children;
+	#else
+		int i = 0;
+		while(i < node->n.num_children && node->keys[i] < c)
+			++i;
+		return i;
+	#endif
+}
+
+static struct art_node **art_find_child(struct art_node *n, unsigned char c)
+{
+	switch(n->type)
+	{
+		case ART_NODE4:
+		{
+			struct art_node4 *node = (struct art_node4*)n;
+			for(int i = 0; i < n->num_children; ++i)
+			{
+				if(node->keys[i] == c)
+					return &node->children[i];
+			}
+			return NULL;
+		}
+		case ART_NODE16:
+		{
+			struct art_node16 *node = (struct art_node16*)n;
+		#ifdef ART_SSE2
+			__m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8((char)c), _mm_loadu_si128((const __m128i*)node->keys));
+			unsigned int mask = (unsigned int)_mm_movemask_epi8(cmp) & ((1u << n->num_children) - 1);
+			return mask ? &node->children[art_ctz(mask)] : NULL;
+		#else
+			for(int i = 0; i < n->num_children; ++i)
+			{
+				if(node->keys[i] == c)
+					return &node->children[i];
+			}
+			return NULL;
+		#endif
+		}
+		case ART_NODE48:
+		{
+			struct art_node48 *node = (struct art_node48*)n;
+			return node->child_index[c] ? &node->children[node->child_index[c] - 1] : NULL;
+		}
+		case ART_NODE256:
+		{
+			struct art_node256 *node = (struct art_node256*)n;
+			return node->children[c] ? &node->children[c] : NULL;
+		}
+	}
+	return NULL;
+}
+
+static struct art_leaf *art_minimum(struct art_node *n)
+{
+	while(n && !ART_IS_LEAF(n))
+	{
+		switch(n->type)
+		{
+			case ART_NODE4:
+				n = ((struct art_node4*)n)->children[0];
+				break;
+			case ART_NODE16:
+				n = ((struct art_node16*)n)->children[0];
+				break;
+			case ART_NODE48:
+			{
+				struct art_node48 *node = (struct art_node48*)n;
+				int c = 0;
+				while(!node->child_index[c])
+					++c;
+				n = node->children[node->child_index[c] - 1];
+				break;
+			}
+			case ART_NODE256:
+			{
+				struct art_node256 *node = (struct art_node256*)n;
+				int c = 0;
+				while(!node->children[c])
+					++c;
+				n = node->children[c];
+				break;
+			}
+		}
+	}
+	return n ? ART_LEAF(n) : NULL;
+}
+
+//compares only the stored part of the prefix, the leaf at the end decides
+static size_t art_check_prefix(const struct art_node *n, const unsigned char *key, size_t key_length, size_t depth)
+{
+	size_t max = n->prefix_length < ART_MAX_PREFIX_LENGTH ? n->prefix_length : ART_MAX_PREFIX_LENGTH;
+	if(max > key_length - depth)
+		max = key_length - depth;
+	size_t i = 0;
+	while(i < max && n->prefix[i] == key[depth + i])
+		++i;
+	return i;
+}
+
+//the whole prefix, past the stored bytes it's read from a leaf below n
+static size_t art_prefix_mismatch(const struct art_node *n, const unsigned char *key, size_t key_length, size_t depth)
+{
+	size_t i = art_check_prefix(n, key, key_length, depth);
+	if(i < ART_MAX_PREFIX_LENGTH || n->prefix_length <= ART_MAX_PREFIX_LENGTH)
+		return i;
+	const unsigned char *full = (const unsigned char*)art_minimum((struct art_node*)n)->key;
+	size_t max = n->prefix_length < key_length - depth ? n->prefix_length : key_length - depth;
+	while(i < max && full[depth + i] == key[depth + i])
+		++i;
+	return i;
+}
+
+//key_length counts the terminating '\0'
+static int art_leaf_matches(const struct art_leaf *l, const char *key, size_t key_length)
+{
+	return l->key_length + 1 == key_length && !memcmp(l->key, key, key_length);
+}
+
+void *art_find(struct art *t, const char *key)
+{
+	size_t key_length = strlen(key) + 1;
+	struct art_node *n = t->root;
+	size_t depth = 0;
+	while(n)
+	{
+		if(ART_IS_LEAF(n))
+		{
+			struct art_leaf *l = ART_LEAF(n);
+			return art_leaf_matches(l, key, key_length) ? l->data : NULL;
+		}
+		if(n->prefix_length)
+		{
+			size_t stored = n->prefix_length < ART_MAX_PREFIX_LENGTH ? n->prefix_length : ART_MAX_PREFIX_LENGTH;
+			if(art_check_prefix(n, (const unsigned char*)key, key_length, depth) != stored)
+				return NULL;
+			depth += n->prefix_length;
+			if(depth >= key_length)
+				return NULL;
+		}
+		struct art_node **child = art_find_child(n, (unsigned char)key[depth]);
+		n = child ? *child : NULL;
+		++depth;
+	}
+	return NULL;
+}
+
+static void art_copy_header(struct art_node *dst, const struct art_node *src)
+{
+	dst->num_children = src->num_children;
+	dst->prefix_length = src->prefix_length;
+	memcpy(dst->prefix, src->prefix, ART_MAX_PREFIX_LENGTH);
+}
+
+static void art_add_child(struct art *t, struct art_node *n, struct art_node **ref, unsigned char c, struct art_node *child);
+
+static void art_add_child256(struct art_node256 *node, unsigned char c, struct art_node *child)
+{
+	node->children[c] = child;
+	++node->n.num_children;
+}
+
+static void art_add_child48(struct art *t, struct art_node48 *node, struct art_node **ref, unsigned char c, struct art_node *child)
+{
+	if(node->n.num_children < 48)
+	{
+		int pos = 0;
+		while(node->children[pos])
+			++pos;
+		node->children[pos] = child;
+		node->child_index[c] = (unsigned char)(pos + 1);
+		++node->n.num_children;
+		return;
+	}
+	struct art_node256 *bigger = (struct art_node256*)art_alloc_node(t, ART_NODE256);
+	for(int i = 0; i < 256; ++i)
+	{
+		if(node->child_index[i])
+			bigger->children[i] = node->children[node->child_index[i] - 1];
+	}
+	art_copy_header(&bigger->n, &node->n);
+	*ref = &bigger->n;
+	memory_deallocate(node);
+	art_add_child256(bigger, c, child);
+}
+
+static void art_add_child16(struct art *t, struct art_node16 *node, struct art_node **ref, unsigned char c, struct art_node *child)
+{
+	if(node->n.num_children < 16)
+	{
+		int pos = art_node16_lower_bound(node, c);
+		memmove(&node->keys[pos + 1], &node->keys[pos], node->n.num_children - pos);
+		memmove(&node->children[pos + 1], &node->children[pos], (node->n.num_children - pos) * sizeof(struct art_node*));
+		node->keys[pos] = c;
+		node->children[pos] = child;
+		++node->n.num_children;
+		return;
+	}
+	struct art_node48 *bigger = (struct art_node48*)art_alloc_node(t, ART_NODE48);
+	memcpy(bigger->children, node->children, sizeof(node->children));
+	for(int i = 0; i < 16; ++i)
+		bigger->child_index[node->keys[i]] = (unsigned char)(i + 1);
+	art_copy_header(&bigger->n, &node->n);
+	*ref = &bigger->n;
+	memory_deallocate(node);
+	art_add_child48(t, bigger, ref, c, child);
+}
+
+static void art_add_child4(struct art *t, struct art_node4 *node, struct art_node **ref, unsigned char c, struct art_node *child)
+{
+	if(node->n.num_children < 4)
+	{
+		int pos = 0;
+		while(pos < node->n.num_children && node->keys[pos] < c)
+			++pos;
+		memmove(&node->keys[pos + 1], &node->keys[pos], node->n.num_children - pos);
+		memmove(&node->children[pos + 1], &node->children[pos], (node->n.num_children - pos) * sizeof(struct art_node*));
+		node->keys[pos] = c;
+		node->children[pos] = child;
+		++node->n.num_children;
+		return;
+	}
+	struct art_node16 *bigger = (struct art_node16*)art_alloc_node(t, ART_NODE16);
+	memcpy(bigger->keys, node->keys, sizeof(node->keys));
+	memcpy(bigger->children, node->children, sizeof(node->children));
+	art_copy_header(&bigger->n, &node->n);
+	*ref = &bigger->n;
+	memory_deallocate(node);
+	art_add_child16(t, bigger, ref, c, child);
+}
+
+//ref is where n hangs in the tree, it's updated when n has to be replaced by a bigger node
+static void art_add_child(struct art *t, struct art_node *n, struct art_node **ref, unsigned char c, struct art_node *child)
+{
+	switch(n->type)
+	{
+		case ART_NODE4: art_add_child4(t, (struct art_node4*)n, ref, c, child); break;
+		case ART_NODE16: art_add_child16(t, (struct art_node16*)n, ref, c, child); break;
+		case ART_NODE48: art_add_child48(t, (struct art_node48*)n, ref, c, child); break;
+		case ART_NODE256: art_add_child256((struct art_node256*)n, c, child); break;
+	}
+}
+
+static int art_insert_recursive(struct art *t, struct art_node **ref, const char *key, size_t key_length, size_t depth, const unsigned char *data)
+{
+	struct art_node *n = *ref;
+	const unsigned char *k = (const unsigned char*)key;
+	if(!n)
+	{
+		*ref = ART_TAG_LEAF(art_alloc_leaf(t, key, key_length - 1, data));
+		return 0;
+	}
+
+	//two leaves under a new node holding their common prefix
+	if(ART_IS_LEAF(n))
+	{
+		struct art_leaf *l = ART_LEAF(n);
+		if(art_leaf_matches(l, key, key_length))
+			return 1;
+		const unsigned char *other = (const unsigned char*)l->key;
+		size_t common = 0;
+		while(other[depth + common] == k[depth + common])
+			++common;
+		struct art_node4 *node = (struct art_node4*)art_alloc_node(t, ART_NODE4);
+		node->n.prefix_length = (uint32_t)common;
+		memcpy(node->n.prefix, &k[depth], common < ART_MAX_PREFIX_LENGTH ? common : ART_MAX_PREFIX_LENGTH);
+		struct art_node *new_ref = &node->n;
+		art_add_child4(t, node, &new_ref, other[depth + common], n);
+		art_add_child4(t, node, &new_ref, k[depth + common], ART_TAG_LEAF(art_alloc_leaf(t, key, key_length - 1, data)));
+		*ref = new_ref;
+		return 0;
+	}
+
+	if(n->prefix_length)
+	{
+		size_t mismatch = art_prefix_mismatch(n, k, key_length, depth);
+		if(mismatch < n->prefix_length)
+		{
+			//the key leaves the prefix early, split it
+			struct art_node4 *node = (struct art_node4*)art_alloc_node(t, ART_NODE4);
+			node->n.prefix_length = (uint32_t)mismatch;
+			memcpy(node->n.prefix, n->prefix, mismatch < ART_MAX_PREFIX_LENGTH ? mismatch : ART_MAX_PREFIX_LENGTH);
+			struct art_node *new_ref = &node->n;
+			if(n->prefix_length <= ART_MAX_PREFIX_LENGTH)
+			{
+				art_add_child4(t, node, &new_ref, n->prefix[mismatch], n);
+				n->prefix_length -= (uint32_t)(mismatch + 1);
+				memmove(n->prefix, n->prefix + mismatch + 1, n->prefix_length);
+			} else
+			{
+				const unsigned char *full = (const unsigned char*)art_minimum(n)->key;
+				art_add_child4(t, node, &new_ref, full[depth + mismatch], n);
+				n->prefix_length -= (uint32_t)(mismatch + 1);
+				memcpy(n->prefix, &full[depth + mismatch + 1], n->prefix_length < ART_MAX_PREFIX_LENGTH ? n->prefix_length : ART_MAX_PREFIX_LENGTH);
+			}
+			art_add_child4(t, node, &new_ref, k[depth + mismatch], ART_TAG_LEAF(art_alloc_leaf(t, key, key_length - 1, data)));
+			*ref = new_ref;
+			return 0;
+		}
+		depth += n->prefix_length;
+	}
+
+	struct art_node **child = art_find_child(n, k[depth]);
+	if(child)
+		return art_insert_recursive(t, child, key, key_length, depth + 1, data);
+	art_add_child(t, n, ref, k[depth], ART_TAG_LEAF(art_alloc_leaf(t, key, key_length - 1, data)));
+	return 0;
+}
+
+int art_insert_data(struct art *t, const char *key, unsigned char *data, size_t data_size)
+{
+	assert(data_size == t->data_size);
+	(void)data_size;
+	if(art_insert_recursive(t, &t->root, key, strlen(key) + 1, 0, data))
+		return 1;
+	++t->num_entries;
+	return 0;
+}
+
+static void art_remove_child256(struct art *t, struct art_node256 *node, struct art_node **ref, unsigned char c)
+{
+	node->children[c] = NULL;
+	//shrink a little below the point where it grew, so a key going in and out doesn't resize every time
+	if(--node->n.num_children == 37)
+	{
+		struct art_node48 *smaller = (struct art_node48*)art_alloc_node(t, ART_NODE48);
+		art_copy_header(&smaller->n, &node->n);
+		int pos = 0;
+		for(int i = 0; i < 256; ++i)
+		{
+			if(node->children[i])
+			{
+				smaller->children[pos] = node->children[i];
+				smaller->child_index[i] = (unsigned char)(pos + 1);
+				++pos;
+			}
+		}
+		*ref = &smaller->n;
+		memory_deallocate(node);
+	}
+}
+
+static void art_remove_child48(struct art *t, struct art_node48 *node, struct art_node **ref, unsigned char c)
+{
+	int pos = node->child_index[c] - 1;
+	node->child_index[c] = 0;
+	node->children[pos] = NULL;
+	if(--node->n.num_children == 12)
+	{
+		struct art_node16 *smaller = (struct art_node16*)art_alloc_node(t, ART_NODE16);
+		art_copy_header(&smaller->n, &node->n);
+		int n = 0;
+		for(int i = 0; i < 256; ++i)
+		{
+			if(node->child_index[i])
+			{
+				smaller->keys[n] = (unsigned char)i;
+				smaller->children[n] = node->children[node->child_index[i] - 1];
+				++n;
+			}
+		}
+		*ref = &smaller->n;
+		memory_deallocate(node);
+	}
+}
+
+static void art_remove_child16(struct art *t, struct art_node16 *node, struct art_node **ref, struct art_node **child)
+{
+	int pos = (int)(child - node->children);
+	memmove(&node->keys[pos], &node->keys[pos + 1], node->n.num_children - 1 - pos);
+	memmove(&node->children[pos], &node->children[pos + 1], (node->n.num_children - 1 - pos) * sizeof(struct art_node*));
+	if(--node->n.num_children == 3)
+	{
+		struct art_node4 *smaller = (struct art_node4*)art_alloc_node(t, ART_NODE4);
+		art_copy_header(&smaller->n, &node->n);
+		memcpy(smaller->keys, node->keys, 3);
+		memcpy(smaller->children, node->children, 3 * sizeof(struct art_node*));
+		*ref = &smaller->n;
+		memory_deallocate(node);
+	}
+}
+
+static void art_remove_child4(struct art_node4 *node, struct art_node **ref, struct art_node **child)
+{
+	int pos = (int)(child - node->children);
+	memmove(&node->keys[pos], &node->keys[pos + 1], node->n.num_children - 1 - pos);
+	memmove(&node->children[pos], &node->children[pos + 1], (node->n.num_children - 1 - pos) * sizeof(struct art_node*));
+	if(--node->n.num_children > 1)
+		return;
+
+	//a single child takes the node's place, its prefix becomes node prefix + key byte + its own prefix
+	struct art_node *only = node->children[0];
+	if(!ART_IS_LEAF(only))
+	{
+		size_t length = node->n.prefix_length;
+		unsigned char prefix[ART_MAX_PREFIX_LENGTH];
+		memcpy(prefix, node->n.prefix, length < ART_MAX_PREFIX_LENGTH ? length : ART_MAX_PREFIX_LENGTH);
+		if(length < ART_MAX_PREFIX_LENGTH)
+			prefix[length] = node->keys[0];
+		++length;
+		for(size_t i = 0; length + i < ART_MAX_PREFIX_LENGTH && i < only->prefix_length; ++i)
+			prefix[length + i] = only->prefix[i];
+		memcpy(only->prefix, prefix, ART_MAX_PREFIX_LENGTH);
+		only->prefix_length += (uint32_t)length;
+	}
+	*ref = only;
+	memory_deallocate(node);
+}
+
+static void art_remove_child(struct art *t, struct art_node *n, struct art_node **ref, unsigned char c, struct art_node **child)
+{
+	switch(n->type)
+	{
+		case ART_NODE4: art_remove_child4((struct art_node4*)n, ref, child); break;
+		case ART_NODE16: art_remove_child16(t, (struct art_node16*)n, ref, child); break;
+		case ART_NODE48: art_remove_child48(t, (struct art_node48*)n, ref, c); break;
+		case ART_NODE256: art_remove_child256(t, (struct art_node256*)n, ref, c); break;
+	}
+}
+
+static struct art_leaf *art_remove_recursive(struct art *t, struct art_node **ref, const char *key, size_t key_length, size_t depth)
+{
+	struct art_node *n = *ref;
+	if(!n)
+		return NULL;
+	if(ART_IS_LEAF(n))
+	{
+		struct art_leaf *l = ART_LEAF(n);
+		if(!art_leaf_matches(l, key, key_length))
+			return NULL;
+		*ref = NULL;
+		return l;
+	}
+	if(n->prefix_length)
+	{
+		size_t stored = n->prefix_length < ART_MAX_PREFIX_LENGTH ? n->prefix_length : ART_MAX_PREFIX_LENGTH;
+		if(art_check_prefix(n, (const unsigned char*)key, key_length, depth) != stored)
+			return NULL;
+		depth += n->prefix_length;
+		if(depth >= key_length)
+			return NULL;
+	}
+	unsigned char c = (unsigned char)key[depth];
+	struct art_node **child = art_find_child(n, c);
+	if(!child)
+		return NULL;
+	if(ART_IS_LEAF(*child))
+	{
+		struct art_leaf *l = ART_LEAF(*child);
+		if(!art_leaf_matches(l, key, key_length))
+			return NULL;
+		art_remove_child(t, n, ref, c, child);
+		return l;
+	}
+	return art_remove_recursive(t, child, key, key_length, depth + 1);
+}
+
+int art_remove_key(struct art *t, const char *key)
+{
+	struct art_leaf *l = art_remove_recursive(t, &t->root, key, strlen(key) + 1, 0);
+	if(!l)
+		return 0;
+	art_free_leaf(t, l);
+	--t->num_entries;
+	return 1;
+}
+
+//children in key order, body can return from the enclosing function
+#define art_foreach_child(n, c, child, body) \
+	do { \
+		switch((n)->type) \
+		{ \
+			case ART_NODE4: \
+			case ART_NODE16: \
+			{ \
+				const unsigned char *keys_ = (n)->type == ART_NODE4 ? ((struct art_node4*)(n))->keys : ((struct art_node16*)(n))->keys; \
+				struct art_node **children_ = (n)->type == ART_NODE4 ? ((struct art_node4*)(n))->children : ((struct art_node16*)(n))->children; \
+				for(int i_ = 0; i_ < (n)->num_children; ++i_) \
+				{ \
+					unsigned char c = keys_[i_]; \
+					struct art_node *child = children_[i_]; \
+					body \
+				} \
+				break; \
+			} \
+			case ART_NODE48: \
+			{ \
+				struct art_node48 *node48_ = (struct art_node48*)(n); \
+				for(int i_ = 0; i_ < 256; ++i_) \
+				{ \
+					if(!node48_->child_index[i_]) continue; \
+					unsigned char c = (unsigned char)i_; \
+					struct art_node *child = node48_->children[node48_->child_index[i_] - 1]; \
+					body \
+				} \
+				break; \
+			} \
+			case ART_NODE256: \
+			{ \
+				struct art_node256 *node256_ = (struct art_node256*)(n); \
+				for(int i_ = 0; i_ < 256; ++i_) \
+				{ \
+					if(!node256_->children[i_]) continue; \
+					unsigned char c = (unsigned char)i_; \
+					struct art_node *child = node256_->children[i_]; \
+					body \
+				} \
+				break; \
+			} \
+		} \
+	} while(0)
+
+static int art_walk(struct art_node *n, art_callback_fn_t fn, void *userptr)
+{
+	if(!n)
+		return 0;
+	if(ART_IS_LEAF(n))
+	{
+		struct art_leaf *l = ART_LEAF(n);
+		return fn(userptr, l->key, l->data);
+	}
+	art_foreach_child(n, c, child,
+	{
+		(void)c;
+		int r = art_walk(child, fn, userptr);
+		if(r)
+			return r;
+	});
+	return 0;
+}
+
+int art_foreach(struct art *t, art_callback_fn_t fn, void *userptr)
+{
+	return art_walk(t->root, fn, userptr);
+}
+
+int art_foreach_prefix(struct art *t, const char *prefix, art_callback_fn_t fn, void *userptr)
+{
+	const unsigned char *p = (const unsigned char*)prefix;
+	size_t prefix_length = strlen(prefix);
+	struct art_node *n = t->root;
+	size_t depth = 0;
+	while(n)
+	{
+		if(ART_IS_LEAF(n))
+		{
+			struct art_leaf *l = ART_LEAF(n);
+			return !strncmp(l->key, prefix, prefix_length) ? fn(userptr, l->key, l->data) : 0;
+		}
+		if(depth == prefix_length)
+			return art_walk(n, fn, userptr);
+		if(n->prefix_length)
+		{
+			size_t mismatch = art_prefix_mismatch(n, p, prefix_length, depth);
+			//the rest of the search prefix is inside the node's prefix, everything below matches
+			if(depth + mismatch == prefix_length)
+				return art_walk(n, fn, userptr);
+			if(mismatch < n->prefix_length)
+				return 0;
+			depth += n->prefix_length;
+		}
+		struct art_node **child = art_find_child(n, p[depth]);
+		n = child ? *child : NULL;
+		++depth;
+	}
+	return 0;
+}
+
+//keys >= from in order, everything below n shares from's first depth bytes
+static int art_walk_from(struct art_node *n, const unsigned char *from, size_t depth, art_callback_fn_t fn, void *userptr)
+{
+	if(ART_IS_LEAF(n))
+	{
+		struct art_leaf *l = ART_LEAF(n);
+		return strcmp(l->key, (const char*)from) >= 0 ? fn(userptr, l->key, l->data) : 0;
+	}
+	if(n->prefix_length)
+	{
+		//prefixes never hold the '\0' that ends from, so this stops at it
+		const unsigned char *prefix = n->prefix_length > ART_MAX_PREFIX_LENGTH ? (const unsigned char*)art_minimum(n)->key + depth : n->prefix;
+		for(size_t i = 0; i < n->prefix_length; ++i)
+		{
+			if(prefix[i] < from[depth + i])
+				return 0;
+			if(prefix[i] > from[depth + i])
+				return art_walk(n, fn, userptr);
+		}
+		depth += n->prefix_length;
+	}
+	unsigned char bound = from[depth];
+	art_foreach_child(n, c, child,
+	{
+		int r = 0;
+		if(c == bound)
+			r = art_walk_from(child, from, depth + 1, fn, userptr);
+		else if(c > bound)
+			r = art_walk(child, fn, userptr);
+		if(r)
+			return r;
+	});
+	return 0;
+}
+
+struct art_range
+{
+	const char *to;
+	art_callback_fn_t fn;
+	void *userptr;
+	int done; //stopped at to
+};
+
+static int art_range_callback(void *userptr, const char *key, void *data)
+{
+	struct art_range *range = userptr;
+	if(range->to && strcmp(key, range->to) >= 0)
+	{
+		range->done = 1;
+		return 1;
+	}
+	return range->fn(range->userptr, key, data);
+}
+
+int art_foreach_range(struct art *t, const char *from, const char *to, art_callback_fn_t fn, void *userptr)
+{
+	struct art_range range = { to, fn, userptr, 0 };
+	if(!t->root)
+		return 0;
+	int r = from ? art_walk_from(t->root, (const unsigned char*)from, 0, art_range_callback, &range) : art_walk(t->root, art_range_callback, &range);
+	return range.done ? 0 : r;
+}
+#endif
+
+#define art_create(type) \
+	art_create_data(sizeof(type), NULL, NULL)
+#define art_create_with_custom_allocator(type, userptr, allocator_fn) \
+	art_create_data(sizeof(type), userptr, allocator_fn)
+#define art_insert(t, key, value) \
+	art_insert_data(t, key, (unsigned char*)&(value), sizeof(value))
+#endif
@@ -4,6 +4,7 @@
 #include "std.h"
 
 #include <string.h>
+#include <stdint.h>
 #include <assert.h>
 #include "memory.h"
 #include "hash_string.h"
@@ -33,6 +34,69 @@ struct hash_bucket
 #define HASH_BUCKET_SIZE (16)
 #define HASH_LOAD_FACTOR (1)
 
+#define HASH_MAP_STATS_HISTOGRAM_SIZE (16)
+
+struct hash_map_stats
+{
+	size_t bucket_count;
+	size_t entries;
+	double load_factor;
+	size_t empty_buckets;
+	size_t longest_chain;
+	//number of buckets with a chain of length i, the last slot counts everything longer too
+	//dense mode: number of entries found after probing i index slots, longest_chain is the longest probe
+	size_t chain_histogram[HASH_MAP_STATS_HISTOGRAM_SIZE];
+	size_t num_rehashes;
+	unsigned long long rehash_ns;
+	
+	size_t removed_entries; //dense mode, slots waiting for compaction
+	
+	size_t key_bytes;
+	size_t entry_bytes; //entry headers (next, hash, key pointer)
+	size_t payload_bytes;
+	size_t bucket_bytes;
+	size_t filter_bytes;
+	size_t total_bytes; //all of the above and the hash_map itself
+	
+	//hash_map_enable_filter, the estimate comes from the filter bits that are set.
+	//the observed rate (finds for missing keys the filter let through) needs HASH_MAP_COUNTERS, 0 without
+	double filter_fp_estimate;
+	double filter_fp_observed;
+	size_t filter_negatives;
+	size_t filter_false_positives;
+};
+
+/*
+compile with HASH_MAP_COUNTERS defined (in every translation unit, it changes struct hash_map) to count
+what each operation does, hm->counters.find.key_compares etc.
+*/
+struct hash_map_op_counters;
+
+#ifdef HASH_MAP_COUNTERS
+struct hash_map_op_counters
+{
+	size_t calls;
+	size_t hits;
+	size_t misses;
+	size_t probes; //entries looked at
+	size_t key_compares; //hashes matched, strcmp was called
+};
+
+struct hash_map_counters
+{
+	struct hash_map_op_counters find;
+	struct hash_map_op_counters insert;
+	struct hash_map_op_counters remove;
+	size_t filter_negatives; //finds answered by the filter alone
+	size_t filter_false_positives; //finds the filter let through that missed
+};
+#define HASH_MAP_OP_COUNTERS(hm, op) (&(hm)->counters.op)
+#define HASH_MAP_COUNT(counters, field) (++(counters)->field)
+#else
+#define HASH_MAP_OP_COUNTERS(hm, op) NULL
+#define HASH_MAP_COUNT(counters, field) ((void)0)
+#endif
+
 struct hash_map
 {
 	struct hash_bucket *buckets;
@@ -44,32 +108,165 @@ struct hash_map
 	int distinct;
 	void *custom_allocator_userptr;
 	custom_allocator_fn_t custom_allocator_fn;
+	
+	size_t num_rehashes;
+	unsigned long long rehash_ns;
+#ifdef HASH_MAP_COUNTERS
+	struct hash_map_counters counters;
+#endif
+	
+	//dense mode (hash_map_create_dense), buckets is NULL and bucket_size 0
+	unsigned char *dense_entries; //entry records in insertion order, removed ones have a NULL key
+	size_t dense_stride;
+	size_t dense_count; //records in use, removed ones included
+	size_t dense_capacity;
+	size_t dense_removed;
+	uint32_t *dense_index; //open addressing, entry index + 1 or 0 for an empty slot
+	size_t dense_index_size; //power of two
+	int dense_index_shift;
+	
+	//resizing, see hash_map_set_incremental
+	struct hash_bucket *old_buckets; //old_buckets[migrate_index..] haven't moved to buckets yet
+	size_t old_bucket_size;
+	size_t migrate_index;
+	int migrate_compact; //entries are copied to fresh memory while they move
+	size_t incremental_step;
+	double shrink_load_factor;
+	
+	//membership filter, see hash_map_enable_filter
+	uint32_t *filter; //filter_blocks blocks of HASH_MAP_FILTER_BLOCK_WORDS words, NULL without a filter
+	size_t filter_blocks;
+	size_t filter_bits_per_key;
+	size_t filter_keys; //added since the last rebuild, removed keys included
 };
 
+/*
+dense mode keeps the entries in one array in insertion order, the hash index only holds 32 bit indices into it.
+hash_map_foreach_entry becomes a linear scan in insertion order, removed entries are skipped until the array is compacted.
+pointers returned by find move when the array grows or is compacted.
+
+struct hash_map *hm = hash_map_create_dense(int);
+*/
+#define HASH_MAP_DENSE_MIN_CAPACITY (16)
+
+/*
+shrinking and compaction, after removing most of the entries:
+
+hash_map_set_shrink_threshold(hm, 0.125); //halve the buckets once less than 1/8 of them are used (the default, 0 never shrinks)
+hash_map_compact(hm); //rebuild at the right size and copy the entries and keys to fresh memory, pointers from find become invalid
+
+resizes (growing, shrinking and hash_map_compact) normally happen at once, after hash_map_set_incremental(hm, n)
+the entries move n buckets at a time on each insert and remove instead, or by calling hash_map_compact_step.
+hash_map_set_incremental(hm, 0) finishes a resize that's still in progress.
+dense maps always compact at once.
+*/
+#define HASH_MAP_SHRINK_LOAD_FACTOR (0.125)
+
+/*
+a split block bloom filter in front of the buckets, for maps where most lookups are for keys that aren't there:
+
+hash_map_enable_filter(hm, 10); //bits per key, about 1% false positives (0 removes the filter)
+
+a find the filter rules out returns NULL without loading a bucket. the filter reuses the key's hash, a key sets
+one bit in each of the 8 words of one 32 byte block so a lookup reads a single block (and the loop vectorizes).
+removed keys stay in the filter until it's rebuilt, which happens after every resize or compaction and once
+the removed keys outnumber the live ones. hash_map_stats reports the estimated and the observed false positive rate.
+*/
+#define HASH_MAP_FILTER_BLOCK_WORDS (8)
+#define HASH_MAP_FILTER_BITS_PER_KEY (10)
+
+//hash_map_insert_batch flags
+#define HASH_MAP_BATCH_UNIQUE (1) //caller guarantees the keys are distinct and not in the map yet, skips the duplicate check
+#define hash_map_is_dense(hm) ((hm)->dense_entries != NULL)
+#define hash_map_dense_entry(hm, i) ((struct hash_bucket_entry*)&(hm)->dense_entries[(i) * (hm)->dense_stride])
+
+//where hash_map_foreach_entry is, dense records first, then the buckets, then the ones a resize hasn't moved yet
+struct hash_map_foreach_state
+{
+	struct hash_map *hm;
+	int table; //0 dense records, 1 buckets, 2 old_buckets
+	size_t index;
+	struct hash_bucket_entry *next; //rest of the current chain
+};
+
+static inline struct hash_bucket_entry *hash_map_foreach_next(struct hash_map_foreach_state *state)
+{
+	struct hash_map *hm = state->hm;
+	struct hash_bucket_entry *entry = state->next;
+	if(entry)
+	{
+		state->next = entry->next;
+		return entry;
+	}
+	if(state->table == 0)
+	{
+		while(state->index < hm->dense_count)
+		{
+			entry = hash_map_dense_entry(hm, state->index++);
+			if(entry->key)
+				return entry;
+		}
+		state->table = 1;
+		state->index = 0;
+	}
+	for(;;)
+	{
+		struct hash_bucket *buckets = state->table == 1 ? hm->buckets : hm->old_buckets;
+		size_t end = state->table == 1 ? hm->bucket_size : hm->old_bucket_size;
+		while(state->index < end)
+		{
+			entry = buckets[state->index++].head;
+			if(entry)
+			{
+				state->next = entry->next;
+				return entry;
+			}
+		}
+		if(state->table == 2)
+			return NULL;
+		state->table = 2;
+		state->index = hm->migrate_index;
+	}
+}
+
+//body is pasted once, break and continue work like in any loop
+#define hash_map_foreach_entry(hm, entry, body) \
+	do { \
+		struct hash_map_foreach_state foreach_state_ = { (hm), 0, 0, NULL }; \
+		struct hash_bucket_entry *entry; \
+		while((entry = hash_map_foreach_next(&foreach_state_)) != NULL) \
+		{ \
+			body \
+		} \
+	} while(0)
+
 #ifndef HASH_MAP_IMPL
 //public API
 extern struct hash_map *hash_map_create_data(size_t data_size, void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn);
+extern struct hash_map *hash_map_create_dense_data(size_t data_size, void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn);
+//sized for capacity entries up front, no rehashing until there are more
+extern struct hash_map *hash_map_create_data_with_capacity(size_t data_size, size_t capacity, void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn);
+extern void hash_map_reserve(struct hash_map *hm, size_t capacity);
+//values is an array of n values of data_size bytes, returns the number of entries inserted
+extern size_t hash_map_insert_batch_data(struct hash_map *hm, const char **keys, const void *values, size_t n, size_t data_size, int flags);
 extern void hash_map_destroy(struct hash_map **hmp);
 extern void *hash_map_find(struct hash_map *ht, const char *key);
+//key doesn't have to be terminated, e.g a slice of the input from parse_buffer_ident
+extern void *hash_map_find_n(struct hash_map *ht, const char *key, size_t key_length);
 extern int hash_map_insert_data(struct hash_map *ht, const char *key, unsigned char *data, size_t data_size);
 extern void hash_map_dump(struct hash_map *hm);
+extern void hash_map_stats(struct hash_map *hm, struct hash_map_stats *stats);
 extern void hash_map_set_on_key_removal(struct hash_map *hm, deallocator_t fn);
 extern int hash_map_remove_key(struct hash_map **hmp, const char *key);
+//0 disables shrinking
+extern void hash_map_set_shrink_threshold(struct hash_map *hm, double load_factor);
+//0 (the default) resizes at once
+extern void hash_map_set_incremental(struct hash_map *hm, size_t buckets_per_operation);
+extern void hash_map_compact(struct hash_map *hm);
+//moves up to max_buckets buckets of a resize or compaction in progress, returns 1 while it isn't done
+extern int hash_map_compact_step(struct hash_map *hm, size_t max_buckets);
+extern void hash_map_enable_filter(struct hash_map *hm, size_t bits_per_key);
 
-#define hash_map_foreach_entry(hm, entry, body) \
-	do { \
-		for(size_t i = 0; i < hm->bucket_size; ++i) \
-		{ \
-			struct hash_bucket *bucket = &hm->buckets[i]; \
-			if(bucket->head == NULL) continue; \
-			struct hash_bucket_entry *entry = bucket->head; \
-			while(entry) \
-			{ \
-				body \
-				entry = entry->next; \
-			} \
-		} \
-	} while(0)
 #else
 
 void hash_map_set_on_key_removal(struct hash_map *hm, deallocator_t fn)
@@ -94,7 +291,15 @@ HM_STATIC struct hash_bucket *hash_allocate_buckets(struct hash_map *hm, size_t
 	return buckets;
 }
 
-struct hash_map *hash_map_create_data(size_t data_size, void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn)
+HM_STATIC size_t hash_map_bucket_count_for(size_t current, size_t capacity)
+{
+	size_t bucket_size = current;
+	while(capacity >= HASH_LOAD_FACTOR * bucket_size)
+		bucket_size *= 2;
+	return bucket_size;
+}
+
+struct hash_map *hash_map_create_data_with_capacity(size_t data_size, size_t capacity, void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn)
 {
 	struct hash_map *ht = NULL;
 	if(custom_allocator_fn && custom_allocator_userptr)
@@ -104,14 +309,348 @@ struct hash_map *hash_map_create_data(size_t data_size, void *custom_allocator_u
 	ht->custom_allocator_fn = custom_allocator_fn;
 	ht->custom_allocator_userptr = custom_allocator_userptr;
 	ht->num_entries = 0;
-	ht->buckets = hash_allocate_buckets(ht, HASH_BUCKET_SIZE);
-	ht->bucket_size = HASH_BUCKET_SIZE;
+	ht->bucket_size = hash_map_bucket_count_for(HASH_BUCKET_SIZE, capacity);
+	ht->buckets = hash_allocate_buckets(ht, ht->bucket_size);
 	ht->data_size = data_size;
 	ht->distinct = 1;
 	ht->on_key_removal_fn = NULL;
+	ht->num_rehashes = 0;
+	ht->rehash_ns = 0;
+#ifdef HASH_MAP_COUNTERS
+	memset(&ht->counters, 0, sizeof(ht->counters));
+#endif
+	ht->dense_entries = NULL;
+	ht->dense_stride = 0;
+	ht->dense_count = 0;
+	ht->dense_capacity = 0;
+	ht->dense_removed = 0;
+	ht->dense_index = NULL;
+	ht->dense_index_size = 0;
+	ht->dense_index_shift = 0;
+	ht->old_buckets = NULL;
+	ht->old_bucket_size = 0;
+	ht->migrate_index = 0;
+	ht->migrate_compact = 0;
+	ht->incremental_step = 0;
+	ht->shrink_load_factor = HASH_MAP_SHRINK_LOAD_FACTOR;
+	ht->filter = NULL;
+	ht->filter_blocks = 0;
+	ht->filter_bits_per_key = 0;
+	ht->filter_keys = 0;
 	return ht;
 }
 
+struct hash_map *hash_map_create_data(size_t data_size, void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn)
+{
+	return hash_map_create_data_with_capacity(data_size, 0, custom_allocator_userptr, custom_allocator_fn);
+}
+
+HM_STATIC void *hash_map_allocate(struct hash_map *hm, size_t n)
+{
+	if(hm->custom_allocator_fn && hm->custom_allocator_userptr)
+		return hm->custom_allocator_fn(hm->custom_allocator_userptr, n);
+	return memory_allocate(n);
+}
+
+//the salts and layout of the parquet split block bloom filter
+static const uint32_t hash_map_filter_salt[HASH_MAP_FILTER_BLOCK_WORDS] = {
+	0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+//djb2 isn't mixed enough to take bits from directly, the high half picks the block and the low half the bits
+HM_STATIC uint64_t hash_map_filter_mix(unsigned long hashed_key)
+{
+	uint64_t h = hashed_key;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+HM_STATIC uint32_t *hash_map_filter_block(struct hash_map *hm, uint64_t h)
+{
+	return &hm->filter[(((h >> 32) * hm->filter_blocks) >> 32) * HASH_MAP_FILTER_BLOCK_WORDS];
+}
+
+HM_STATIC void hash_map_filter_add(struct hash_map *hm, unsigned long hashed_key)
+{
+	uint64_t h = hash_map_filter_mix(hashed_key);
+	uint32_t *block = hash_map_filter_block(hm, h);
+	for(int i = 0; i < HASH_MAP_FILTER_BLOCK_WORDS; ++i)
+		block[i] |= (uint32_t)1 << (((uint32_t)h * hash_map_filter_salt[i]) >> 27);
+	++hm->filter_keys;
+}
+
+HM_STATIC int hash_map_filter_maybe_contains(struct hash_map *hm, unsigned long hashed_key)
+{
+	uint64_t h = hash_map_filter_mix(hashed_key);
+	const uint32_t *block = hash_map_filter_block(hm, h);
+	uint32_t missing = 0;
+	for(int i = 0; i < HASH_MAP_FILTER_BLOCK_WORDS; ++i)
+		missing |= ~block[i] & ((uint32_t)1 << (((uint32_t)h * hash_map_filter_salt[i]) >> 27));
+	return missing == 0;
+}
+
+//sized for as many keys as the map holds before its next resize
+HM_STATIC void hash_map_filter_rebuild(struct hash_map *hm)
+{
+	size_t capacity = hash_map_is_dense(hm) ? hm->dense_index_size / 2 : hm->bucket_size * HASH_LOAD_FACTOR;
+	if(capacity < hm->num_entries)
+		capacity = hm->num_entries;
+	size_t blocks = (capacity * hm->filter_bits_per_key + 32 * HASH_MAP_FILTER_BLOCK_WORDS - 1) / (32 * HASH_MAP_FILTER_BLOCK_WORDS);
+	if(blocks != hm->filter_blocks)
+	{
+		if(hm->filter)
+			memory_deallocate(hm->filter);
+		hm->filter = hash_map_allocate(hm, sizeof(uint32_t) * HASH_MAP_FILTER_BLOCK_WORDS * blocks);
+		hm->filter_blocks = blocks;
+	}
+	memset(hm->filter, 0, sizeof(uint32_t) * HASH_MAP_FILTER_BLOCK_WORDS * blocks);
+	hm->filter_keys = 0;
+	hash_map_foreach_entry(hm, entry,
+	{
+		hash_map_filter_add(hm, entry->hash);
+	});
+}
+
+//a key the filter rules out is new, inserting it doesn't have to look for it
+HM_STATIC int hash_map_filter_check_insert(struct hash_map *hm, unsigned long hashed_key)
+{
+	return !hm->filter || hash_map_filter_maybe_contains(hm, hashed_key);
+}
+
+void hash_map_enable_filter(struct hash_map *hm, size_t bits_per_key)
+{
+	if(hm->filter)
+		memory_deallocate(hm->filter);
+	hm->filter = NULL;
+	hm->filter_blocks = 0;
+	hm->filter_bits_per_key = bits_per_key;
+	hm->filter_keys = 0;
+	if(bits_per_key)
+		hash_map_filter_rebuild(hm);
+}
+
+HM_STATIC int hash_popcount32(uint32_t x)
+{
+	x = x - ((x >> 1) & 0x55555555U);
+	x = (x & 0x33333333U) + ((x >> 2) & 0x33333333U);
+	return (int)((((x + (x >> 4)) & 0x0f0f0f0fU) * 0x01010101U) >> 24);
+}
+
+//a missing key lands on a random block and passes if its 8 bits happen to be set there
+HM_STATIC double hash_map_filter_fp_estimate(struct hash_map *hm)
+{
+	double sum = 0.0;
+	for(size_t b = 0; b < hm->filter_blocks; ++b)
+	{
+		double p = 1.0;
+		for(int i = 0; i < HASH_MAP_FILTER_BLOCK_WORDS; ++i)
+			p *= hash_popcount32(hm->filter[b * HASH_MAP_FILTER_BLOCK_WORDS + i]) / 32.0;
+		sum += p;
+	}
+	return hm->filter_blocks ? sum / hm->filter_blocks : 0.0;
+}
+
+#define HASH_MAP_KEY_TERMINATED ((size_t)-1)
+#define HASH_MAP_DENSE_NOT_FOUND ((size_t)-1)
+
+HM_STATIC size_t hash_map_dense_home(struct hash_map *hm, unsigned long hashed_key)
+{
+	//djb2's low bits are weak, fibonacci hashing keeps the well mixed high bits of the product
+	return (size_t)(((uint64_t)hashed_key * 0x9E3779B97F4A7C15ULL) >> hm->dense_index_shift);
+}
+
+HM_STATIC void hash_map_dense_index_insert(struct hash_map *hm, size_t entry_index)
+{
+	size_t mask = hm->dense_index_size - 1;
+	size_t slot = hash_map_dense_home(hm, hash_map_dense_entry(hm, entry_index)->hash);
+	while(hm->dense_index[slot])
+		slot = (slot + 1) & mask;
+	hm->dense_index[slot] = (uint32_t)(entry_index + 1);
+}
+
+HM_STATIC void hash_map_dense_rebuild_index(struct hash_map *hm, size_t index_size)
+{
+	unsigned long long start = std_time_ns();
+	if(index_size != hm->dense_index_size)
+	{
+		if(hm->dense_index)
+			memory_deallocate(hm->dense_index);
+		hm->dense_index = hash_map_allocate(hm, sizeof(uint32_t) * index_size);
+		hm->dense_index_size = index_size;
+		int bits = 0;
+		while(((size_t)1 << bits) < index_size)
+			++bits;
+		hm->dense_index_shift = 64 - bits;
+	}
+	memset(hm->dense_index, 0, sizeof(uint32_t) * index_size);
+	for(size_t i = 0; i < hm->dense_count; ++i)
+	{
+		if(hash_map_dense_entry(hm, i)->key)
+			hash_map_dense_index_insert(hm, i);
+	}
+	if(hm->filter)
+		hash_map_filter_rebuild(hm);
+	++hm->num_rehashes;
+	hm->rehash_ns += std_time_ns() - start;
+}
+
+struct hash_map *hash_map_create_dense_data(size_t data_size, void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn)
+{
+	struct hash_map *hm = hash_map_create_data(data_size, custom_allocator_userptr, custom_allocator_fn);
+	memory_deallocate(hm->buckets);
+	hm->buckets = NULL;
+	hm->bucket_size = 0;
+	//records look like a hash_bucket_entry, so hash_map_foreach_entry bodies work in both modes.
+	//they start on 16 byte boundaries like malloc'd chained entries, so values get the same alignment in both
+	hm->dense_stride = (sizeof(struct hash_bucket_entry) + data_size + 15) & ~(size_t)15;
+	hm->dense_capacity = HASH_MAP_DENSE_MIN_CAPACITY;
+	hm->dense_entries = hash_map_allocate(hm, hm->dense_stride * hm->dense_capacity);
+	hash_map_dense_rebuild_index(hm, HASH_MAP_DENSE_MIN_CAPACITY * 2);
+	hm->num_rehashes = 0;
+	hm->rehash_ns = 0;
+	return hm;
+}
+
+//returns the index slot holding key or HASH_MAP_DENSE_NOT_FOUND, the index always has empty slots so probing ends
+HM_STATIC size_t hash_map_dense_find_slot(struct hash_map *hm, const char *key, size_t key_length, unsigned long hashed_key, struct hash_map_op_counters *counters)
+{
+	(void)counters;
+	HASH_MAP_COUNT(counters, calls);
+	size_t mask = hm->dense_index_size - 1;
+	for(size_t slot = hash_map_dense_home(hm, hashed_key); hm->dense_index[slot]; slot = (slot + 1) & mask)
+	{
+		struct hash_bucket_entry *entry = hash_map_dense_entry(hm, hm->dense_index[slot] - 1);
+		HASH_MAP_COUNT(counters, probes);
+		if(entry->hash != hashed_key)
+			continue;
+		HASH_MAP_COUNT(counters, key_compares);
+		if(key_length == HASH_MAP_KEY_TERMINATED ? !strcmp(entry->key, key) : !strncmp(entry->key, key, key_length) && entry->key[key_length] == '\0')
+		{
+			HASH_MAP_COUNT(counters, hits);
+			return slot;
+		}
+	}
+	HASH_MAP_COUNT(counters, misses);
+	return HASH_MAP_DENSE_NOT_FOUND;
+}
+
+//moves the removed entries out, insertion order is kept
+HM_STATIC void hash_map_dense_compact(struct hash_map *hm)
+{
+	size_t n = 0;
+	for(size_t i = 0; i < hm->dense_count; ++i)
+	{
+		struct hash_bucket_entry *entry = hash_map_dense_entry(hm, i);
+		if(!entry->key)
+			continue;
+		if(i != n)
+			memcpy(hash_map_dense_entry(hm, n), entry, hm->dense_stride);
+		++n;
+	}
+	hm->dense_count = n;
+	hm->dense_removed = 0;
+	hash_map_dense_rebuild_index(hm, hm->dense_index_size);
+}
+
+HM_STATIC void hash_map_dense_grow(struct hash_map *hm, size_t capacity)
+{
+	unsigned char *entries = hash_map_allocate(hm, hm->dense_stride * capacity);
+	memcpy(entries, hm->dense_entries, hm->dense_stride * hm->dense_count);
+	memory_deallocate(hm->dense_entries);
+	hm->dense_entries = entries;
+	hm->dense_capacity = capacity;
+}
+
+HM_STATIC void hash_map_dense_reserve(struct hash_map *hm, size_t capacity)
+{
+	//removed records take up room until the array is compacted
+	if(capacity + hm->dense_removed > hm->dense_capacity)
+	{
+		if(hm->dense_removed)
+			hash_map_dense_compact(hm);
+		if(capacity > hm->dense_capacity)
+			hash_map_dense_grow(hm, capacity);
+	}
+	size_t index_size = hm->dense_index_size;
+	while(capacity * 2 > index_size)
+		index_size *= 2;
+	if(index_size != hm->dense_index_size)
+		hash_map_dense_rebuild_index(hm, index_size);
+}
+
+HM_STATIC void hash_map_dense_insert(struct hash_map *hm, const char *key, unsigned long hashed_key, const unsigned char *data, size_t data_size)
+{
+	assert(hm->dense_count < UINT32_MAX - 1);
+	if(hm->dense_count == hm->dense_capacity)
+	{
+		//reuse the removed records if there are enough of them, otherwise double
+		if(hm->dense_removed >= hm->dense_capacity / 4)
+			hash_map_dense_compact(hm);
+		else
+			hash_map_dense_grow(hm, hm->dense_capacity * 2);
+	}
+	
+	size_t index = hm->dense_count++;
+	struct hash_bucket_entry *entry = hash_map_dense_entry(hm, index);
+	size_t kl = strlen(key);
+	entry->next = NULL;
+	entry->hash = hashed_key;
+	entry->key = hash_map_allocate(hm, kl + 1);
+	memcpy(entry->key, key, kl + 1);
+	memcpy(entry->data, data, data_size);
+	++hm->num_entries;
+	if(hm->filter)
+		hash_map_filter_add(hm, hashed_key);
+	
+	//keep the index at most half full
+	if(hm->num_entries * 2 > hm->dense_index_size)
+		hash_map_dense_rebuild_index(hm, hm->dense_index_size * 2);
+	else
+		hash_map_dense_index_insert(hm, index);
+}
+
+HM_STATIC int hash_map_dense_remove(struct hash_map *hm, const char *key)
+{
+	size_t slot = hash_map_dense_find_slot(hm, key, HASH_MAP_KEY_TERMINATED, hash_string(key), HASH_MAP_OP_COUNTERS(hm, remove));
+	if(slot == HASH_MAP_DENSE_NOT_FOUND)
+		return 0;
+	size_t index = hm->dense_index[slot] - 1;
+	
+	//backward shift deletion, pull later entries of the probe run into the hole so lookups don't need tombstones
+	size_t mask = hm->dense_index_size - 1;
+	size_t hole = slot;
+	for(size_t next = (slot + 1) & mask; hm->dense_index[next]; next = (next + 1) & mask)
+	{
+		size_t home = hash_map_dense_home(hm, hash_map_dense_entry(hm, hm->dense_index[next] - 1)->hash);
+		//an entry whose home lies cyclically in (hole, next] is already where it should be
+		int stays = hole <= next ? (home > hole && home <= next) : (home > hole || home <= next);
+		if(stays)
+			continue;
+		hm->dense_index[hole] = hm->dense_index[next];
+		hole = next;
+	}
+	hm->dense_index[hole] = 0;
+	
+	struct hash_bucket_entry *entry = hash_map_dense_entry(hm, index);
+	if(hm->on_key_removal_fn)
+		hm->on_key_removal_fn(entry->data);
+	memory_deallocate(entry->key);
+	entry->key = NULL;
+	--hm->num_entries;
+	if(index + 1 == hm->dense_count)
+		--hm->dense_count;
+	else
+		++hm->dense_removed;
+	
+	if(hm->dense_removed > HASH_MAP_DENSE_MIN_CAPACITY && hm->dense_removed > hm->num_entries)
+		hash_map_dense_compact(hm);
+	return 1;
+}
+
 HM_STATIC void hash_bucket_free(struct hash_map *hm, struct hash_bucket *bucket)
 {
 	if(bucket->head == NULL)
@@ -131,9 +670,166 @@ HM_STATIC void hash_bucket_free(struct hash_map *hm, struct hash_bucket *bucket)
 	bucket->head = NULL;
 }
 
+//copies the entry and its key to fresh memory, used by hash_map_compact
+HM_STATIC struct hash_bucket_entry *hash_map_repack_entry(struct hash_map *hm, struct hash_bucket_entry *entry)
+{
+	size_t kl = strlen(entry->key);
+	struct hash_bucket_entry *copy = hash_map_allocate(hm, sizeof(struct hash_bucket_entry) + hm->data_size);
+	memcpy(copy, entry, sizeof(struct hash_bucket_entry) + hm->data_size);
+	copy->key = hash_map_allocate(hm, kl + 1);
+	memcpy(copy->key, entry->key, kl + 1);
+	memory_deallocate(entry->key);
+	memory_deallocate(entry);
+	return copy;
+}
+
+//moves up to max_buckets old buckets into the new table, entries keep their hash and are only relinked
+HM_STATIC void hash_map_migrate(struct hash_map *hm, size_t max_buckets)
+{
+	if(!hm->old_buckets)
+		return;
+	unsigned long long start = std_time_ns();
+	size_t end = hm->old_bucket_size - hm->migrate_index > max_buckets ? hm->migrate_index + max_buckets : hm->old_bucket_size;
+	for(; hm->migrate_index < end; ++hm->migrate_index)
+	{
+		struct hash_bucket_entry *cur = hm->old_buckets[hm->migrate_index].head;
+		while(cur != NULL)
+		{
+			struct hash_bucket_entry *next = cur->next;
+			if(hm->migrate_compact)
+				cur = hash_map_repack_entry(hm, cur);
+			struct hash_bucket *new_bucket = &hm->buckets[cur->hash % hm->bucket_size];
+			cur->next = new_bucket->head;
+			new_bucket->head = cur;
+			++new_bucket->size;
+			cur = next;
+		}
+		hm->old_buckets[hm->migrate_index].head = NULL;
+	}
+	if(hm->migrate_index == hm->old_bucket_size)
+	{
+		memory_deallocate(hm->old_buckets);
+		hm->old_buckets = NULL;
+		hm->old_bucket_size = 0;
+		hm->migrate_index = 0;
+		hm->migrate_compact = 0;
+		//keys were added to the old filter all along, it's only resized here
+		if(hm->filter)
+			hash_map_filter_rebuild(hm);
+	}
+	hm->rehash_ns += std_time_ns() - start;
+}
+
+//a resize already in progress is finished first, with incremental_step set the entries move a few buckets per insert/remove
+HM_STATIC void hash_map_resize(struct hash_map *hm, size_t new_bucket_size, int compact, int incremental)
+{
+	hash_map_migrate(hm, (size_t)-1);
+	hm->old_buckets = hm->buckets;
+	hm->old_bucket_size = hm->bucket_size;
+	hm->migrate_index = 0;
+	hm->migrate_compact = compact;
+	hm->buckets = hash_allocate_buckets(hm, new_bucket_size);
+	hm->bucket_size = new_bucket_size;
+	++hm->num_rehashes;
+	if(!incremental)
+		hash_map_migrate(hm, (size_t)-1);
+}
+
+//while resizing an entry is in the old table if its old bucket hasn't moved yet
+HM_STATIC struct hash_bucket *hash_map_bucket(struct hash_map *hm, unsigned long hashed_key)
+{
+	if(hm->old_buckets)
+	{
+		size_t old = hashed_key % hm->old_bucket_size;
+		if(old >= hm->migrate_index)
+			return &hm->old_buckets[old];
+	}
+	return &hm->buckets[hashed_key % hm->bucket_size];
+}
+
+HM_STATIC void hash_map_dense_shrink(struct hash_map *hm, size_t capacity)
+{
+	if(hm->dense_removed)
+		hash_map_dense_compact(hm);
+	if(capacity < HASH_MAP_DENSE_MIN_CAPACITY)
+		capacity = HASH_MAP_DENSE_MIN_CAPACITY;
+	if(capacity != hm->dense_capacity)
+		hash_map_dense_grow(hm, capacity);
+	size_t index_size = HASH_MAP_DENSE_MIN_CAPACITY * 2;
+	while(capacity * 2 > index_size)
+		index_size *= 2;
+	if(index_size != hm->dense_index_size)
+		hash_map_dense_rebuild_index(hm, index_size);
+}
+
+void hash_map_set_shrink_threshold(struct hash_map *hm, double load_factor)
+{
+	hm->shrink_load_factor = load_factor;
+}
+
+void hash_map_set_incremental(struct hash_map *hm, size_t buckets_per_operation)
+{
+	hm->incremental_step = buckets_per_operation;
+	//nothing would move the rest of a pending resize anymore
+	if(buckets_per_operation == 0)
+		hash_map_migrate(hm, SIZE_MAX);
+}
+
+void hash_map_compact(struct hash_map *hm)
+{
+	if(hash_map_is_dense(hm))
+	{
+		hash_map_dense_shrink(hm, hm->num_entries);
+		return;
+	}
+	hash_map_resize(hm, hash_map_bucket_count_for(HASH_BUCKET_SIZE, hm->num_entries), 1, hm->incremental_step != 0);
+}
+
+int hash_map_compact_step(struct hash_map *hm, size_t max_buckets)
+{
+	hash_map_migrate(hm, max_buckets);
+	return hm->old_buckets != NULL;
+}
+
+HM_STATIC void hash_map_after_remove(struct hash_map *hm)
+{
+	if(hm->filter && hm->filter_keys > 2 * hm->num_entries + HASH_BUCKET_SIZE)
+		hash_map_filter_rebuild(hm);
+	if(hm->shrink_load_factor <= 0.0)
+		return;
+	if(hash_map_is_dense(hm))
+	{
+		if(hm->dense_capacity > HASH_MAP_DENSE_MIN_CAPACITY && hm->num_entries < hm->shrink_load_factor * hm->dense_capacity)
+			hash_map_dense_shrink(hm, hm->num_entries * 2); //room to grow again without reallocating
+		return;
+	}
+	if(!hm->old_buckets && hm->bucket_size > HASH_BUCKET_SIZE && hm->num_entries < hm->shrink_load_factor * hm->bucket_size)
+		hash_map_resize(hm, hash_map_bucket_count_for(HASH_BUCKET_SIZE, hm->num_entries), 0, hm->incremental_step != 0);
+}
+
 void hash_map_destroy(struct hash_map **hmp)
 {
 	struct hash_map *hm = *hmp;
+	if(hm->filter)
+		memory_deallocate(hm->filter);
+	
+	if(hash_map_is_dense(hm))
+	{
+		for(size_t i = 0; i < hm->dense_count; ++i)
+		{
+			struct hash_bucket_entry *entry = hash_map_dense_entry(hm, i);
+			if(!entry->key)
+				continue;
+			if(hm->on_key_removal_fn)
+				hm->on_key_removal_fn(entry->data);
+			memory_deallocate(entry->key);
+		}
+		memory_deallocate(hm->dense_entries);
+		memory_deallocate(hm->dense_index);
+		memory_deallocate(hm);
+		*hmp = NULL;
+		return;
+	}
 	
 	for(size_t i = 0; i < hm->bucket_size; ++i)
 	{
@@ -143,43 +839,107 @@ void hash_map_destroy(struct hash_map **hmp)
 		hash_bucket_free(hm, bucket);
 	}
 	memory_deallocate(hm->buckets);
+	for(size_t i = hm->migrate_index; i < hm->old_bucket_size; ++i)
+		hash_bucket_free(hm, &hm->old_buckets[i]);
+	if(hm->old_buckets)
+		memory_deallocate(hm->old_buckets);
 	
 	memory_deallocate(hm);
 	*hmp = NULL;
 }
 
-HM_STATIC struct hash_bucket_entry *hash_bucket_find(struct hash_bucket *bucket, const char *key, unsigned long hashed_key)
+//counters is NULL (and unused) without HASH_MAP_COUNTERS, key_length is HASH_MAP_KEY_TERMINATED for a terminated key
+HM_STATIC struct hash_bucket_entry *hash_bucket_find_n(struct hash_bucket *bucket, const char *key, size_t key_length, unsigned long hashed_key, struct hash_map_op_counters *counters)
 {
-	if(bucket->head == NULL)
-		return NULL; //empty bucket
-	
-	struct hash_bucket_entry *cur = bucket->head;
-	
-	for(;;)
+	(void)counters;
+	HASH_MAP_COUNT(counters, calls);
+	for(struct hash_bucket_entry *cur = bucket->head; cur; cur = cur->next)
 	{
-		if(cur->hash == hashed_key && !strcmp(cur->key, key))
+		HASH_MAP_COUNT(counters, probes);
+		if(cur->hash != hashed_key)
+			continue;
+		HASH_MAP_COUNT(counters, key_compares);
+		if(key_length == HASH_MAP_KEY_TERMINATED ? !strcmp(cur->key, key) : !strncmp(cur->key, key, key_length) && cur->key[key_length] == '\0')
+		{
+			HASH_MAP_COUNT(counters, hits);
 			return cur;
-		if(cur->next == NULL)
-			break;
-		cur = cur->next;
+		}
 	}
+	HASH_MAP_COUNT(counters, misses);
 	return NULL;
 }
 
+HM_STATIC struct hash_bucket_entry *hash_bucket_find(struct hash_bucket *bucket, const char *key, unsigned long hashed_key, struct hash_map_op_counters *counters)
+{
+	return hash_bucket_find_n(bucket, key, HASH_MAP_KEY_TERMINATED, hashed_key, counters);
+}
+
+//returns 0 if the filter says the key isn't there. find stays read only unless HASH_MAP_COUNTERS is defined
+HM_STATIC int hash_map_filter_check(struct hash_map *ht, unsigned long hashed_key)
+{
+	if(!ht->filter || hash_map_filter_maybe_contains(ht, hashed_key))
+		return 1;
+#ifdef HASH_MAP_COUNTERS
+	++ht->counters.filter_negatives;
+#endif
+	return 0;
+}
+
+HM_STATIC void *hash_map_filter_result(struct hash_map *ht, void *data)
+{
+#ifdef HASH_MAP_COUNTERS
+	if(!data && ht->filter)
+		++ht->counters.filter_false_positives;
+#else
+	(void)ht;
+#endif
+	return data;
+}
+
 void *hash_map_find(struct hash_map *ht, const char *key)
 {
 	unsigned long hashed_key = hash_string(key);
-	struct hash_bucket *bucket = &ht->buckets[hashed_key % ht->bucket_size];
-	struct hash_bucket_entry *entry = hash_bucket_find(bucket, key, hashed_key);
-	return entry ? entry->data : NULL;
+	if(!hash_map_filter_check(ht, hashed_key))
+		return NULL;
+	if(hash_map_is_dense(ht))
+	{
+		size_t slot = hash_map_dense_find_slot(ht, key, HASH_MAP_KEY_TERMINATED, hashed_key, HASH_MAP_OP_COUNTERS(ht, find));
+		return hash_map_filter_result(ht, slot == HASH_MAP_DENSE_NOT_FOUND ? NULL : hash_map_dense_entry(ht, ht->dense_index[slot] - 1)->data);
+	}
+	struct hash_bucket *bucket = hash_map_bucket(ht, hashed_key);
+	struct hash_bucket_entry *entry = hash_bucket_find(bucket, key, hashed_key, HASH_MAP_OP_COUNTERS(ht, find));
+	return hash_map_filter_result(ht, entry ? entry->data : NULL);
+}
+
+void *hash_map_find_n(struct hash_map *ht, const char *key, size_t key_length)
+{
+	unsigned long hashed_key = hash_string_n(key, key_length);
+	if(!hash_map_filter_check(ht, hashed_key))
+		return NULL;
+	if(hash_map_is_dense(ht))
+	{
+		size_t slot = hash_map_dense_find_slot(ht, key, key_length, hashed_key, HASH_MAP_OP_COUNTERS(ht, find));
+		return hash_map_filter_result(ht, slot == HASH_MAP_DENSE_NOT_FOUND ? NULL : hash_map_dense_entry(ht, ht->dense_index[slot] - 1)->data);
+	}
+	struct hash_bucket *bucket = hash_map_bucket(ht, hashed_key);
+	struct hash_bucket_entry *entry = hash_bucket_find_n(bucket, key, key_length, hashed_key, HASH_MAP_OP_COUNTERS(ht, find));
+	return hash_map_filter_result(ht, entry ? entry->data : NULL);
 }
 
 int hash_map_remove_key(struct hash_map **hmp, const char *key)
 {
 	struct hash_map *ht = *hmp;
+	if(hash_map_is_dense(ht))
+	{
+		int removed = hash_map_dense_remove(ht, key);
+		if(removed)
+			hash_map_after_remove(ht);
+		return removed;
+	}
+	hash_map_migrate(ht, ht->incremental_step);
 	unsigned long hashed_key = hash_string(key);
-	struct hash_bucket *bucket = &ht->buckets[hashed_key % ht->bucket_size];
-	struct hash_bucket_entry *entry = hash_bucket_find(bucket, key, hashed_key);
+	struct hash_bucket *bucket = hash_map_bucket(ht, hashed_key);
+	struct hash_bucket_entry *entry = hash_bucket_find(bucket, key, hashed_key, HASH_MAP_OP_COUNTERS(ht, remove));
     if(!entry)
         return 0;
     
@@ -195,23 +955,108 @@ int hash_map_remove_key(struct hash_map **hmp, const char *key)
 
 	--bucket->size;
     --ht->num_entries;
+	hash_map_after_remove(ht);
 	return 1;
 }
 
+void hash_map_stats(struct hash_map *hm, struct hash_map_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+	stats->bucket_count = hm->bucket_size;
+	stats->entries = hm->num_entries;
+	stats->load_factor = hm->bucket_size ? (double)hm->num_entries / hm->bucket_size : 0.0;
+	stats->num_rehashes = hm->num_rehashes;
+	stats->rehash_ns = hm->rehash_ns;
+	stats->filter_bytes = hm->filter_blocks * HASH_MAP_FILTER_BLOCK_WORDS * sizeof(uint32_t);
+	stats->filter_fp_estimate = hash_map_filter_fp_estimate(hm);
+#ifdef HASH_MAP_COUNTERS
+	stats->filter_negatives = hm->counters.filter_negatives;
+	stats->filter_false_positives = hm->counters.filter_false_positives;
+	if(stats->filter_negatives + stats->filter_false_positives)
+		stats->filter_fp_observed = (double)stats->filter_false_positives / (stats->filter_negatives + stats->filter_false_positives);
+#endif
+	
+	if(hash_map_is_dense(hm))
+	{
+		stats->bucket_count = hm->dense_index_size;
+		stats->load_factor = (double)hm->num_entries / hm->dense_index_size;
+		stats->removed_entries = hm->dense_removed;
+		size_t mask = hm->dense_index_size - 1;
+		for(size_t slot = 0; slot < hm->dense_index_size; ++slot)
+		{
+			if(!hm->dense_index[slot])
+			{
+				++stats->empty_buckets;
+				continue;
+			}
+			struct hash_bucket_entry *entry = hash_map_dense_entry(hm, hm->dense_index[slot] - 1);
+			stats->key_bytes += strlen(entry->key) + 1;
+			size_t probes = ((slot - hash_map_dense_home(hm, entry->hash)) & mask) + 1;
+			if(probes > stats->longest_chain)
+				stats->longest_chain = probes;
+			++stats->chain_histogram[probes < HASH_MAP_STATS_HISTOGRAM_SIZE ? probes : HASH_MAP_STATS_HISTOGRAM_SIZE - 1];
+		}
+		stats->entry_bytes = hm->dense_capacity * sizeof(struct hash_bucket_entry);
+		stats->payload_bytes = hm->dense_capacity * (hm->dense_stride - sizeof(struct hash_bucket_entry));
+		stats->bucket_bytes = hm->dense_index_size * sizeof(uint32_t);
+		stats->total_bytes = stats->key_bytes + stats->entry_bytes + stats->payload_bytes + stats->bucket_bytes + stats->filter_bytes + sizeof(struct hash_map);
+		return;
+	}
+	
+	//buckets of a resize in progress count too
+	for(size_t i = 0; i < hm->bucket_size + hm->old_bucket_size; ++i)
+	{
+		struct hash_bucket *bucket = i < hm->bucket_size ? &hm->buckets[i] : &hm->old_buckets[i - hm->bucket_size];
+		if(i >= hm->bucket_size && i - hm->bucket_size < hm->migrate_index)
+			continue;
+		size_t length = 0;
+		for(struct hash_bucket_entry *cur = bucket->head; cur; cur = cur->next)
+		{
+			stats->key_bytes += strlen(cur->key) + 1;
+			++length;
+		}
+		if(!length)
+			++stats->empty_buckets;
+		if(length > stats->longest_chain)
+			stats->longest_chain = length;
+		++stats->chain_histogram[length < HASH_MAP_STATS_HISTOGRAM_SIZE ? length : HASH_MAP_STATS_HISTOGRAM_SIZE - 1];
+	}
+	stats->entry_bytes = hm->num_entries * sizeof(struct hash_bucket_entry);
+	stats->payload_bytes = hm->num_entries * hm->data_size;
+	stats->bucket_bytes = (hm->bucket_size + hm->old_bucket_size) * sizeof(struct hash_bucket);
+	stats->total_bytes = stats->key_bytes + stats->entry_bytes + stats->payload_bytes + stats->bucket_bytes + stats->filter_bytes + sizeof(struct hash_map);
+}
+
 void hash_map_dump(struct hash_map *hm)
 {
-	#if 0
-	for(size_t i = 0; i < hm->bucket_size; ++i)
+	struct hash_map_stats stats;
+	hash_map_stats(hm, &stats);
+	printf("%zu entries in %zu buckets (load factor %.2f, %zu empty)\n", stats.entries, stats.bucket_count, stats.load_factor, stats.empty_buckets);
+	printf("longest chain %zu\n", stats.longest_chain);
+	for(size_t i = 0; i < HASH_MAP_STATS_HISTOGRAM_SIZE; ++i)
 	{
-		struct hash_bucket *bucket = &hm->buckets[i];
-		printf("bucket %lu: %lu entries\n", i, bucket->size);
+		if(stats.chain_histogram[i])
+			printf("\tchain length %zu%s: %zu buckets\n", i, i + 1 == HASH_MAP_STATS_HISTOGRAM_SIZE ? "+" : "", stats.chain_histogram[i]);
 	}
-	#endif
+	printf("%zu rehashes taking %.3f ms\n", stats.num_rehashes, stats.rehash_ns / 1e6);
+	if(hash_map_is_dense(hm))
+		printf("dense, %zu removed entries waiting for compaction\n", stats.removed_entries);
+	printf("%zu bytes: keys %zu, entries %zu, payload %zu, buckets %zu, filter %zu\n", stats.total_bytes, stats.key_bytes, stats.entry_bytes, stats.payload_bytes, stats.bucket_bytes, stats.filter_bytes);
+	if(hm->filter)
+		printf("filter: %.2f%% false positives estimated\n", stats.filter_fp_estimate * 100.0);
+#ifdef HASH_MAP_COUNTERS
+	if(hm->filter)
+		printf("filter: %.2f%% false positives observed (%zu of %zu misses got past it)\n", stats.filter_fp_observed * 100.0,
+			stats.filter_false_positives, stats.filter_negatives + stats.filter_false_positives);
+	const struct hash_map_op_counters *ops[] = { &hm->counters.find, &hm->counters.insert, &hm->counters.remove };
+	const char *names[] = { "find", "insert", "remove" };
+	for(int i = 0; i < 3; ++i)
+		printf("%s: %zu calls, %zu hits, %zu misses, %zu probes, %zu key compares\n", names[i], ops[i]->calls, ops[i]->hits, ops[i]->misses, ops[i]->probes, ops[i]->key_compares);
+#endif
 }
 
-HM_STATIC struct hash_bucket_entry *hash_bucket_entry_create(struct hash_map *hm, const char *key, unsigned char *data, size_t data_size)
+HM_STATIC struct hash_bucket_entry *hash_bucket_entry_create(struct hash_map *hm, const char *key, unsigned long hashed_key, const unsigned char *data, size_t data_size)
 {
-	unsigned long hashed_key = hash_string(key);
 	struct hash_bucket_entry *entry = NULL;
 	
 	if(hm->custom_allocator_fn && hm->custom_allocator_userptr)
@@ -233,9 +1078,11 @@ HM_STATIC struct hash_bucket_entry *hash_bucket_entry_create(struct hash_map *hm
 	return entry;
 }
 
-HM_STATIC void hash_bucket_insert(struct hash_map *hm, struct hash_bucket *bucket, const char *key, unsigned char *data, size_t data_size)
+HM_STATIC void hash_bucket_insert(struct hash_map *hm, struct hash_bucket *bucket, const char *key, unsigned long hashed_key, const unsigned char *data, size_t data_size)
 {
-	struct hash_bucket_entry *entry = hash_bucket_entry_create(hm, key, data, data_size);
+	struct hash_bucket_entry *entry = hash_bucket_entry_create(hm, key, hashed_key, data, data_size);
+	if(hm->filter)
+		hash_map_filter_add(hm, hashed_key);
 	
 	++bucket->size;
 	
@@ -253,28 +1100,77 @@ HM_STATIC void hash_bucket_insert(struct hash_map *hm, struct hash_bucket *bucke
 
 HM_STATIC void hash_map_rehash(struct hash_map *hm)
 {
-	size_t new_bucket_size = hm->bucket_size * 2;
-	struct hash_bucket *new_buckets = hash_allocate_buckets(hm, new_bucket_size);
-	//fill the new buckets with old data
-	for(size_t i = 0; i < hm->bucket_size; ++i)
+	hash_map_resize(hm, hm->bucket_size * 2, 0, hm->incremental_step != 0);
+}
+
+void hash_map_reserve(struct hash_map *hm, size_t capacity)
+{
+	if(hash_map_is_dense(hm))
 	{
-		struct hash_bucket *bucket = &hm->buckets[i];
-		if(bucket->head == NULL)
-			continue; //skip.. empty bucket
-		struct hash_bucket_entry *cur = bucket->head;
-		while(cur != NULL)
+		hash_map_dense_reserve(hm, capacity);
+		return;
+	}
+	hash_map_migrate(hm, (size_t)-1);
+	size_t bucket_size = hash_map_bucket_count_for(hm->bucket_size, capacity);
+	if(bucket_size != hm->bucket_size)
+		hash_map_resize(hm, bucket_size, 0, 0);
+}
+
+size_t hash_map_insert_batch_data(struct hash_map *hm, const char **keys, const void *values, size_t n, size_t data_size, int flags)
+{
+	assert(data_size == hm->data_size);
+	if(!n)
+		return 0;
+	const unsigned char *data = values;
+	size_t inserted = 0;
+	int check = hm->distinct && !(flags & HASH_MAP_BATCH_UNIQUE);
+	
+	//size the table once, nothing gets rehashed while inserting
+	hash_map_reserve(hm, hm->num_entries + n);
+	unsigned long *hashes = memory_allocate(sizeof(unsigned long) * n);
+	for(size_t i = 0; i < n; ++i)
+		hashes[i] = hash_string(keys[i]);
+	
+	if(hash_map_is_dense(hm))
+	{
+		//insertion order is the batch order
+		for(size_t i = 0; i < n; ++i)
 		{
-			struct hash_bucket *new_bucket = &new_buckets[cur->hash % new_bucket_size];
-			//hash map num entries stays the same, we're just rehashing, not adding new entries
-			hash_bucket_insert(hm, new_bucket, cur->key, cur->data, hm->data_size);
-			cur = cur->next;
+			if(check && hash_map_filter_check_insert(hm, hashes[i]) && hash_map_dense_find_slot(hm, keys[i], HASH_MAP_KEY_TERMINATED, hashes[i], HASH_MAP_OP_COUNTERS(hm, insert)) != HASH_MAP_DENSE_NOT_FOUND)
+				continue;
+			hash_map_dense_insert(hm, keys[i], hashes[i], &data[i * data_size], data_size);
+			++inserted;
 		}
-		//free old bucket
-		hash_bucket_free(hm, bucket);
+		memory_deallocate(hashes);
+		return inserted;
 	}
-	memory_deallocate(hm->buckets);
-	hm->bucket_size = new_bucket_size;
-	hm->buckets = new_buckets;
+	
+	//counting sort by bucket, then the buckets are filled in memory order
+	size_t *offsets = memory_allocate(sizeof(size_t) * (hm->bucket_size + 1));
+	size_t *order = memory_allocate(sizeof(size_t) * n);
+	memset(offsets, 0, sizeof(size_t) * (hm->bucket_size + 1));
+	for(size_t i = 0; i < n; ++i)
+		++offsets[hashes[i] % hm->bucket_size + 1];
+	for(size_t b = 0; b < hm->bucket_size; ++b)
+		offsets[b + 1] += offsets[b];
+	//keys in the same bucket keep their batch order, the first of two equal keys wins like with hash_map_insert
+	for(size_t i = 0; i < n; ++i)
+		order[offsets[hashes[i] % hm->bucket_size]++] = i;
+	
+	for(size_t k = 0; k < n; ++k)
+	{
+		size_t i = order[k];
+		struct hash_bucket *bucket = &hm->buckets[hashes[i] % hm->bucket_size];
+		if(check && hash_map_filter_check_insert(hm, hashes[i]) && hash_bucket_find(bucket, keys[i], hashes[i], HASH_MAP_OP_COUNTERS(hm, insert)))
+			continue;
+		hash_bucket_insert(hm, bucket, keys[i], hashes[i], &data[i * data_size], data_size);
+		++inserted;
+	}
+	hm->num_entries += inserted;
+	memory_deallocate(order);
+	memory_deallocate(offsets);
+	memory_deallocate(hashes);
+	return inserted;
 }
 
 int hash_map_insert_data(struct hash_map *ht, const char *key, unsigned char *data, size_t data_size)
@@ -282,15 +1178,24 @@ int hash_map_insert_data(struct hash_map *ht, const char *key, unsigned char *da
 	assert(data_size == ht->data_size);
 	
 	unsigned long hashed_key = hash_string(key);
-	struct hash_bucket *bucket = &ht->buckets[hashed_key % ht->bucket_size];
+	int check = ht->distinct && hash_map_filter_check_insert(ht, hashed_key);
+	if(hash_map_is_dense(ht))
+	{
+		if(check && hash_map_dense_find_slot(ht, key, HASH_MAP_KEY_TERMINATED, hashed_key, HASH_MAP_OP_COUNTERS(ht, insert)) != HASH_MAP_DENSE_NOT_FOUND)
+			return 1;
+		hash_map_dense_insert(ht, key, hashed_key, data, data_size);
+		return 0;
+	}
+	hash_map_migrate(ht, ht->incremental_step);
+	struct hash_bucket *bucket = hash_map_bucket(ht, hashed_key);
 	
 	//unique keys
-	if(ht->distinct && hash_bucket_find(bucket, key, hashed_key) != NULL)
+	if(check && hash_bucket_find(bucket, key, hashed_key, HASH_MAP_OP_COUNTERS(ht, insert)) != NULL)
 		return 1;
 	
 	++ht->num_entries;
 	
-	hash_bucket_insert(ht, bucket, key, data, data_size);
+	hash_bucket_insert(ht, bucket, key, hashed_key, data, data_size);
 	
 	//probably should rehash before insertion
 	if(ht->num_entries >= HASH_LOAD_FACTOR * ht->bucket_size)
@@ -309,7 +1214,16 @@ int hash_map_insert_data(struct hash_map *ht, const char *key, unsigned char *da
 	hash_map_create_data(sizeof(type), NULL, NULL)
 #define hash_map_create_with_custom_allocator(type, userptr, allocator_fn) \
 	hash_map_create_data(sizeof(type), userptr, allocator_fn)
+#define hash_map_create_with_capacity(type, capacity) \
+	hash_map_create_data_with_capacity(sizeof(type), capacity, NULL, NULL)
+#define hash_map_create_dense(type) \
+	hash_map_create_dense_data(sizeof(type), NULL, NULL)
+#define hash_map_create_dense_with_custom_allocator(type, userptr, allocator_fn) \
+	hash_map_create_dense_data(sizeof(type), userptr, allocator_fn)
 
 #define hash_map_insert(ht, key, value) \
 	hash_map_insert_data(ht, key, (unsigned char*)&(value), sizeof(value))
+//values is a typed array, e.g int values[n]
+#define hash_map_insert_batch(ht, keys, values, n, flags) \
+	hash_map_insert_batch_data(ht, keys, values, n, sizeof(*(values)), flags)
 #endif
\ No newline at end of file
@@ -0,0 +1,243 @@
+#ifndef HASH_MAP_PARALLEL_H
+#define HASH_MAP_PARALLEL_H
+
+#include "memory.h"
+#include "hash_map.h"
+#include "thread.h"
+
+/*
+builds a hash_map from arrays of keys and values on a pool of threads, the result is a normal chained hash_map.
+the keys are hashed and split by bucket range into partitions, every thread fills whole partitions so no two threads
+touch the same bucket and nothing is locked while inserting.
+
+const char **keys = ...;
+struct mesh *meshes = ...; //meshes[i] belongs to keys[i]
+struct hash_map *hm = hash_map_build_parallel(keys, meshes, n, 0, 0);
+
+like hash_map_insert_batch the first of two equal keys wins, HASH_MAP_BATCH_UNIQUE skips the duplicate check.
+a custom allocator is called from the worker threads, so it has to be thread safe.
+*/
+
+#define HASH_MAP_PARALLEL_PARTITIONS_PER_THREAD (16)
+#define HASH_MAP_PARALLEL_MIN_KEYS_PER_THREAD (16384) //fewer keys than this are inserted on the calling thread
+
+#ifndef HASH_MAP_PARALLEL_IMPL
+//num_threads <= 0 uses the number of cores, values is an array of n values of data_size bytes
+extern struct hash_map *hash_map_build_parallel_data(const char **keys, const void *values, size_t n, size_t data_size, int flags, int num_threads,
+	void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn);
+#else
+
+struct hash_map_parallel_job
+{
+	struct hash_map *hm;
+	const char **keys;
+	const unsigned char *values;
+	size_t n;
+	int check;
+
+	unsigned long *hashes;
+	size_t *order; //key indices grouped by partition, in key order within a partition
+	size_t *offsets; //num_threads * num_partitions, per thread counts and then scatter positions
+	size_t *partition_begin; //num_partitions + 1
+	size_t num_partitions;
+	int num_threads;
+
+	size_t next_partition;
+	size_t inserted;
+	thread_mutex_t mutex;
+};
+
+struct hash_map_parallel_worker
+{
+	struct hash_map_parallel_job *job;
+	int index;
+};
+
+//partitions are contiguous bucket ranges
+#define hash_map_parallel_partition(job, hashed_key) \
+	((hashed_key) % (job)->hm->bucket_size * (job)->num_partitions / (job)->hm->bucket_size)
+
+static void hash_map_parallel_count(void *userptr)
+{
+	struct hash_map_parallel_worker *worker = userptr;
+	struct hash_map_parallel_job *job = worker->job;
+	size_t *counts = &job->offsets[worker->index * job->num_partitions];
+	size_t begin = job->n * worker->index / job->num_threads;
+	size_t end = job->n * (worker->index + 1) / job->num_threads;
+	for(size_t i = begin; i < end; ++i)
+	{
+		job->hashes[i] = hash_string(job->keys[i]);
+		++counts[hash_map_parallel_partition(job, job->hashes[i])];
+	}
+}
+
+static void hash_map_parallel_scatter(void *userptr)
+{
+	struct hash_map_parallel_worker *worker = userptr;
+	struct hash_map_parallel_job *job = worker->job;
+	size_t *positions = &job->offsets[worker->index * job->num_partitions];
+	size_t begin = job->n * worker->index / job->num_threads;
+	size_t end = job->n * (worker->index + 1) / job->num_threads;
+	for(size_t i = begin; i < end; ++i)
+		job->order[positions[hash_map_parallel_partition(job, job->hashes[i])]++] = i;
+}
+
+static struct hash_bucket_entry *hash_map_parallel_find(struct hash_bucket *bucket, const char *key, unsigned long hashed_key)
+{
+	for(struct hash_bucket_entry *cur = bucket->head; cur; cur = cur->next)
+	{
+		if(cur->hash == hashed_key && !strcmp(cur->key, key))
+			return cur;
+	}
+	return NULL;
+}
+
+static void *hash_map_parallel_allocate(struct hash_map *hm, size_t n)
+{
+	if(hm->custom_allocator_fn && hm->custom_allocator_userptr)
+		return hm->custom_allocator_fn(hm->custom_allocator_userptr, n);
+	return memory_allocate(n);
+}
+
+static size_t hash_map_parallel_fill_partition(struct hash_map_parallel_job *job, size_t partition)
+{
+	struct hash_map *hm = job->hm;
+	size_t inserted = 0;
+	for(size_t k = job->partition_begin[partition]; k < job->partition_begin[partition + 1]; ++k)
+	{
+		size_t i = job->order[k];
+		const char *key = job->keys[i];
+		unsigned long hashed_key = job->hashes[i];
+		struct hash_bucket *bucket = &hm->buckets[hashed_key % hm->bucket_size];
+		if(job->check && hash_map_parallel_find(bucket, key, hashed_key))
+			continue;
+
+		size_t kl = strlen(key);
+		struct hash_bucket_entry *entry = hash_map_parallel_allocate(hm, sizeof(struct hash_bucket_entry) + hm->data_size);
+		entry->hash = hashed_key;
+		entry->key = hash_map_parallel_allocate(hm, kl + 1);
+		memcpy(entry->key, key, kl + 1);
+		memcpy(entry->data, &job->values[i * hm->data_size], hm->data_size);
+		entry->next = bucket->head;
+		bucket->head = entry;
+		++bucket->size;
+		++inserted;
+	}
+	return inserted;
+}
+
+static void hash_map_parallel_fill(void *userptr)
+{
+	struct hash_map_parallel_worker *worker = userptr;
+	struct hash_map_parallel_job *job = worker->job;
+	size_t inserted = 0;
+	for(;;)
+	{
+		thread_mutex_lock(&job->mutex);
+		size_t partition = job->next_partition++;
+		thread_mutex_unlock(&job->mutex);
+		if(partition >= job->num_partitions)
+			break;
+		inserted += hash_map_parallel_fill_partition(job, partition);
+	}
+	thread_mutex_lock(&job->mutex);
+	job->inserted += inserted;
+	thread_mutex_unlock(&job->mutex);
+}
+
+//runs fn once per worker, the calling thread is worker 0 and takes over the workers whose thread didn't start
+static void hash_map_parallel_run(struct hash_map_parallel_job *job, struct hash_map_parallel_worker *workers, thread_t *threads, thread_fn_t fn)
+{
+	int *started = memory_allocate(sizeof(int) * job->num_threads);
+	for(int i = 1; i < job->num_threads; ++i)
+		started[i] = !thread_create(&threads[i], fn, &workers[i]);
+	fn(&workers[0]);
+	for(int i = 1; i < job->num_threads; ++i)
+	{
+		if(started[i])
+			thread_join(threads[i]);
+		else
+			fn(&workers[i]);
+	}
+	memory_deallocate(started);
+}
+
+struct hash_map *hash_map_build_parallel_data(const char **keys, const void *values, size_t n, size_t data_size, int flags, int num_threads,
+	void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn)
+{
+	//sized up front, the buckets never move while the threads fill them
+	struct hash_map *hm = hash_map_create_data_with_capacity(data_size, n, custom_allocator_userptr, custom_allocator_fn);
+	if(num_threads <= 0)
+		num_threads = thread_hardware_concurrency();
+	if((size_t)num_threads > n / HASH_MAP_PARALLEL_MIN_KEYS_PER_THREAD)
+		num_threads = (int)(n / HASH_MAP_PARALLEL_MIN_KEYS_PER_THREAD);
+	if(num_threads <= 1)
+	{
+		hash_map_insert_batch_data(hm, keys, values, n, data_size, flags);
+		return hm;
+	}
+
+	struct hash_map_parallel_job job;
+	job.hm = hm;
+	job.keys = keys;
+	job.values = values;
+	job.n = n;
+	job.check = !(flags & HASH_MAP_BATCH_UNIQUE);
+	job.num_threads = num_threads;
+	job.num_partitions = (size_t)num_threads * HASH_MAP_PARALLEL_PARTITIONS_PER_THREAD;
+	if(job.num_partitions > hm->bucket_size)
+		job.num_partitions = hm->bucket_size;
+	job.hashes = memory_allocate(sizeof(unsigned long) * n);
+	job.order = memory_allocate(sizeof(size_t) * n);
+	job.offsets = memory_allocate(sizeof(size_t) * num_threads * job.num_partitions);
+	job.partition_begin = memory_allocate(sizeof(size_t) * (job.num_partitions + 1));
+	memset(job.offsets, 0, sizeof(size_t) * num_threads * job.num_partitions);
+	job.next_partition = 0;
+	job.inserted = 0;
+	thread_mutex_init(&job.mutex);
+
+	struct hash_map_parallel_worker *workers = memory_allocate(sizeof(struct hash_map_parallel_worker) * num_threads);
+	thread_t *threads = memory_allocate(sizeof(thread_t) * num_threads);
+	for(int i = 0; i < num_threads; ++i)
+	{
+		workers[i].job = &job;
+		workers[i].index = i;
+	}
+
+	hash_map_parallel_run(&job, workers, threads, hash_map_parallel_count);
+
+	//turn the per thread counts into scatter positions, partition major and thread order within a partition
+	//so every partition lists its keys in the order they were passed in and the first duplicate wins
+	size_t pos = 0;
+	for(size_t p = 0; p < job.num_partitions; ++p)
+	{
+		job.partition_begin[p] = pos;
+		for(int t = 0; t < num_threads; ++t)
+		{
+			size_t count = job.offsets[t * job.num_partitions + p];
+			job.offsets[t * job.num_partitions + p] = pos;
+			pos += count;
+		}
+	}
+	job.partition_begin[job.num_partitions] = pos;
+
+	hash_map_parallel_run(&job, workers, threads, hash_map_parallel_scatter);
+	hash_map_parallel_run(&job, workers, threads, hash_map_parallel_fill);
+	hm->num_entries = job.inserted;
+
+	thread_mutex_destroy(&job.mutex);
+	memory_deallocate(threads);
+	memory_deallocate(workers);
+	memory_deallocate(job.partition_begin);
+	memory_deallocate(job.offsets);
+	memory_deallocate(job.order);
+	memory_deallocate(job.hashes);
+	return hm;
+}
+#endif
+
+#define hash_map_build_parallel(keys, values, n, flags, num_threads) \
+	hash_map_build_parallel_data(keys, values, n, sizeof(*(values)), flags, num_threads, NULL, NULL)
+#define hash_map_build_parallel_with_custom_allocator(keys, values, n, flags, num_threads, userptr, allocator_fn) \
+	hash_map_build_parallel_data(keys, values, n, sizeof(*(values)), flags, num_threads, userptr, allocator_fn)
+#endif
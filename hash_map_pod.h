@@ -0,0 +1,279 @@
+#ifndef HASH_MAP_POD_H
+#define HASH_MAP_POD_H
+
+#include "std.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include "memory.h"
+
+/*
+hash_map keyed by fixed size plain old data (uint64_t ids, small structs) instead of strings.
+the key is stored inline in the entry in front of the value, hashed with an integer mixer and compared with memcmp,
+so struct keys with padding have to be zeroed (memset) before filling them in.
+
+struct hash_map_pod *hm = hash_map_pod_create_u64(struct mesh*);
+hash_map_u64_insert(hm, 1234, mesh);
+struct mesh **m = hash_map_u64_find(hm, 1234);
+
+struct cell { int32_t x, y; } key = { 3, 4 };
+struct hash_map_pod *grid = hash_map_pod_create(struct cell, float);
+hash_map_pod_insert(grid, key, density);
+float *d = hash_map_pod_find(grid, &key);
+*/
+
+#pragma warning( push )
+#pragma warning( disable : 4200 )
+struct hash_map_pod_entry
+{
+	struct hash_map_pod_entry *next;
+	uint64_t hash;
+	unsigned char data[]; //key, padded to 8 bytes, then the value
+};
+#pragma warning( pop )
+
+#define HASH_MAP_POD_BUCKET_SIZE (16) //power of two, the hash is masked
+#define HASH_MAP_POD_LOAD_FACTOR (1)
+
+struct hash_map_pod
+{
+	struct hash_map_pod_entry **buckets;
+	size_t bucket_size;
+	size_t key_size;
+	size_t key_stride;
+	size_t data_size;
+	size_t num_entries;
+
+	deallocator_t on_key_removal_fn;
+	void *custom_allocator_userptr;
+	custom_allocator_fn_t custom_allocator_fn;
+
+	size_t num_rehashes;
+	unsigned long long rehash_ns;
+};
+
+#define hash_map_pod_entry_key(entry) ((void*)(entry)->data)
+#define hash_map_pod_entry_value(hm, entry) ((void*)&(entry)->data[(hm)->key_stride])
+
+#define hash_map_pod_foreach_entry(hm, entry, body) \
+	do { \
+		for(size_t i = 0; i < (hm)->bucket_size; ++i) \
+		{ \
+			struct hash_map_pod_entry *entry = (hm)->buckets[i]; \
+			while(entry) \
+			{ \
+				body \
+				entry = entry->next; \
+			} \
+		} \
+	} while(0)
+
+//murmur3's finalizer, every input bit affects every output bit and it's a bijection on 64 bits
+static inline uint64_t hash_map_pod_mix64(uint64_t h)
+{
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+static inline uint64_t hash_map_pod_hash(const void *key, size_t key_size)
+{
+	const unsigned char *p = key;
+	uint64_t h = key_size;
+	while(key_size >= 8)
+	{
+		uint64_t w;
+		memcpy(&w, p, 8);
+		h = hash_map_pod_mix64(h ^ w);
+		p += 8;
+		key_size -= 8;
+	}
+	if(key_size)
+	{
+		uint64_t w = 0;
+		memcpy(&w, p, key_size);
+		h = hash_map_pod_mix64(h ^ w);
+	}
+	return h;
+}
+
+#ifndef HASH_MAP_POD_IMPL
+extern struct hash_map_pod *hash_map_pod_create_data(size_t key_size, size_t data_size, void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn);
+extern void hash_map_pod_destroy(struct hash_map_pod **hmp);
+extern void hash_map_pod_set_on_key_removal(struct hash_map_pod *hm, deallocator_t fn);
+extern void *hash_map_pod_find(struct hash_map_pod *hm, const void *key);
+//returns 1 if the key already exists (and doesn't insert), same as hash_map_insert
+extern int hash_map_pod_insert_data(struct hash_map_pod *hm, const void *key, size_t key_size, unsigned char *data, size_t data_size);
+extern int hash_map_pod_remove_key(struct hash_map_pod *hm, const void *key);
+#else
+
+void hash_map_pod_set_on_key_removal(struct hash_map_pod *hm, deallocator_t fn)
+{
+	hm->on_key_removal_fn = fn;
+}
+
+static void *hash_map_pod_allocate(struct hash_map_pod *hm, size_t n)
+{
+	if(hm->custom_allocator_fn && hm->custom_allocator_userptr)
+		return hm->custom_allocator_fn(hm->custom_allocator_userptr, n);
+	return memory_allocate(n);
+}
+
+static struct hash_map_pod_entry **hash_map_pod_allocate_buckets(struct hash_map_pod *hm, size_t num_buckets)
+{
+	struct hash_map_pod_entry **buckets = hash_map_pod_allocate(hm, sizeof(struct hash_map_pod_entry*) * num_buckets);
+	memset(buckets, 0, sizeof(struct hash_map_pod_entry*) * num_buckets);
+	return buckets;
+}
+
+struct hash_map_pod *hash_map_pod_create_data(size_t key_size, size_t data_size, void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn)
+{
+	struct hash_map_pod *hm = NULL;
+	if(custom_allocator_fn && custom_allocator_userptr)
+		hm = custom_allocator_fn(custom_allocator_userptr, sizeof(struct hash_map_pod));
+	else
+		hm = memory_allocate(sizeof(struct hash_map_pod));
+	hm->custom_allocator_fn = custom_allocator_fn;
+	hm->custom_allocator_userptr = custom_allocator_userptr;
+	hm->key_size = key_size;
+	hm->key_stride = (key_size + 7) & ~(size_t)7;
+	hm->data_size = data_size;
+	hm->num_entries = 0;
+	hm->on_key_removal_fn = NULL;
+	hm->num_rehashes = 0;
+	hm->rehash_ns = 0;
+	hm->buckets = hash_map_pod_allocate_buckets(hm, HASH_MAP_POD_BUCKET_SIZE);
+	hm->bucket_size = HASH_MAP_POD_BUCKET_SIZE;
+	return hm;
+}
+
+void hash_map_pod_destroy(struct hash_map_pod **hmp)
+{
+	struct hash_map_pod *hm = *hmp;
+	for(size_t i = 0; i < hm->bucket_size; ++i)
+	{
+		struct hash_map_pod_entry *cur = hm->buckets[i];
+		while(cur)
+		{
+			struct hash_map_pod_entry *tmp = cur;
+			cur = cur->next;
+			if(hm->on_key_removal_fn)
+				hm->on_key_removal_fn(hash_map_pod_entry_value(hm, tmp));
+			memory_deallocate(tmp);
+		}
+	}
+	memory_deallocate(hm->buckets);
+	memory_deallocate(hm);
+	*hmp = NULL;
+}
+
+//the mixer is a bijection, so for 8 byte keys equal hashes means equal keys
+#define hash_map_pod_key_equals(hm, entry, key, hashed_key) \
+	((entry)->hash == (hashed_key) && ((hm)->key_size == 8 || !memcmp((entry)->data, (key), (hm)->key_size)))
+
+static struct hash_map_pod_entry **hash_map_pod_find_link(struct hash_map_pod *hm, const void *key, uint64_t hashed_key)
+{
+	struct hash_map_pod_entry **cur = &hm->buckets[hashed_key & (hm->bucket_size - 1)];
+	for(; *cur; cur = &(*cur)->next)
+	{
+		if(hash_map_pod_key_equals(hm, *cur, key, hashed_key))
+			return cur;
+	}
+	return NULL;
+}
+
+void *hash_map_pod_find(struct hash_map_pod *hm, const void *key)
+{
+	uint64_t hashed_key = hash_map_pod_hash(key, hm->key_size);
+	for(struct hash_map_pod_entry *cur = hm->buckets[hashed_key & (hm->bucket_size - 1)]; cur; cur = cur->next)
+	{
+		if(hash_map_pod_key_equals(hm, cur, key, hashed_key))
+			return hash_map_pod_entry_value(hm, cur);
+	}
+	return NULL;
+}
+
+int hash_map_pod_remove_key(struct hash_map_pod *hm, const void *key)
+{
+	struct hash_map_pod_entry **link = hash_map_pod_find_link(hm, key, hash_map_pod_hash(key, hm->key_size));
+	if(!link)
+		return 0;
+	struct hash_map_pod_entry *entry = *link;
+	*link = entry->next;
+	if(hm->on_key_removal_fn)
+		hm->on_key_removal_fn(hash_map_pod_entry_value(hm, entry));
+	memory_deallocate(entry);
+	--hm->num_entries;
+	return 1;
+}
+
+//entries keep their hash, they're only relinked
+static void hash_map_pod_rehash(struct hash_map_pod *hm)
+{
+	unsigned long long start = std_time_ns();
+	size_t new_bucket_size = hm->bucket_size * 2;
+	struct hash_map_pod_entry **new_buckets = hash_map_pod_allocate_buckets(hm, new_bucket_size);
+	for(size_t i = 0; i < hm->bucket_size; ++i)
+	{
+		struct hash_map_pod_entry *cur = hm->buckets[i];
+		while(cur)
+		{
+			struct hash_map_pod_entry *next = cur->next;
+			struct hash_map_pod_entry **head = &new_buckets[cur->hash & (new_bucket_size - 1)];
+			cur->next = *head;
+			*head = cur;
+			cur = next;
+		}
+	}
+	memory_deallocate(hm->buckets);
+	hm->buckets = new_buckets;
+	hm->bucket_size = new_bucket_size;
+	++hm->num_rehashes;
+	hm->rehash_ns += std_time_ns() - start;
+}
+
+int hash_map_pod_insert_data(struct hash_map_pod *hm, const void *key, size_t key_size, unsigned char *data, size_t data_size)
+{
+	assert(key_size == hm->key_size);
+	assert(data_size == hm->data_size);
+
+	uint64_t hashed_key = hash_map_pod_hash(key, key_size);
+	if(hash_map_pod_find_link(hm, key, hashed_key))
+		return 1;
+
+	struct hash_map_pod_entry *entry = hash_map_pod_allocate(hm, sizeof(struct hash_map_pod_entry) + hm->key_stride + data_size);
+	entry->hash = hashed_key;
+	memcpy(entry->data, key, key_size);
+	memcpy(&entry->data[hm->key_stride], data, data_size);
+
+	struct hash_map_pod_entry **head = &hm->buckets[hashed_key & (hm->bucket_size - 1)];
+	entry->next = *head;
+	*head = entry;
+
+	if(++hm->num_entries >= HASH_MAP_POD_LOAD_FACTOR * hm->bucket_size)
+		hash_map_pod_rehash(hm);
+	return 0;
+}
+#endif
+
+#define hash_map_pod_create(key_type, type) \
+	hash_map_pod_create_data(sizeof(key_type), sizeof(type), NULL, NULL)
+#define hash_map_pod_create_with_custom_allocator(key_type, type, userptr, allocator_fn) \
+	hash_map_pod_create_data(sizeof(key_type), sizeof(type), userptr, allocator_fn)
+#define hash_map_pod_insert(hm, key, value) \
+	hash_map_pod_insert_data(hm, &(key), sizeof(key), (unsigned char*)&(value), sizeof(value))
+
+//uint64_t keys, the key can be any integer expression
+#define hash_map_pod_create_u64(type) \
+	hash_map_pod_create(uint64_t, type)
+#define hash_map_u64_insert(hm, key, value) \
+	hash_map_pod_insert_data(hm, &(uint64_t){ (key) }, sizeof(uint64_t), (unsigned char*)&(value), sizeof(value))
+#define hash_map_u64_find(hm, key) \
+	hash_map_pod_find(hm, &(uint64_t){ (key) })
+#define hash_map_u64_remove_key(hm, key) \
+	hash_map_pod_remove_key(hm, &(uint64_t){ (key) })
+#endif
@@ -0,0 +1,416 @@
+#ifndef HASH_MAP_RCU_H
+#define HASH_MAP_RCU_H
+
+#include <stdatomic.h>
+#include "memory.h"
+#include "hash_map.h"
+#include "array.h"
+#include "thread.h"
+
+/*
+a hash_map for many readers and one writer, readers never lock or wait.
+readers get an immutable snapshot (a normal struct hash_map, use hash_map_find/hash_map_foreach_entry on it),
+the writer changes a private copy and publishes it as the next snapshot.
+
+//reader thread
+struct hash_map_rcu_reader *reader = hash_map_rcu_reader_register(config);
+struct hash_map *snapshot = hash_map_rcu_read_begin(config, reader);
+struct setting *s = hash_map_find(snapshot, "max_connections");
+...
+hash_map_rcu_read_end(reader); //s and snapshot can't be used after this
+hash_map_rcu_reader_unregister(reader);
+
+//writer thread
+hash_map_rcu_set(config, "max_connections", setting);
+hash_map_rcu_remove_key(config, "legacy_mode");
+hash_map_rcu_publish(config); //readers see both changes from now on
+
+a new version copies the bucket array once (on the first change after a publish) and shares the chains with
+the previous one, a change only copies the entries in front of the changed one in its bucket.
+replaced and removed entries and old versions are retired and freed (on_key_removal_fn runs on the value) by the writer
+once no reader that started before the publish is still reading, see hash_map_rcu_reclaim.
+
+snapshots must not be changed or destroyed with the hash_map functions and HASH_MAP_COUNTERS isn't safe here,
+find would write the counters from every reader.
+*/
+
+#define HASH_MAP_RCU_MAX_READERS (64)
+
+struct hash_map_rcu_reader
+{
+	atomic_size_t epoch; //epoch the current read started in, 0 while not reading
+	atomic_int used;
+	char pad[64 - sizeof(atomic_size_t) - sizeof(atomic_int)]; //a cache line per reader
+};
+
+//what to do with a retired pointer once no reader can see it
+#define HASH_MAP_RCU_FREE_ENTRY (1)
+#define HASH_MAP_RCU_FREE_KEY (2)
+#define HASH_MAP_RCU_FINALIZE (4) //on_key_removal_fn on the value
+#define HASH_MAP_RCU_FREE_VERSION (8) //struct hash_map and its bucket array, the entries live on in the next version
+
+struct hash_map_rcu_retired
+{
+	void *ptr;
+	size_t epoch;
+	int flags;
+};
+
+struct hash_map_rcu
+{
+	struct hash_map *_Atomic current; //published snapshot
+	struct hash_map *pending; //the writer's next version, NULL until the first change after a publish
+	atomic_size_t epoch; //incremented by every publish, starts at 1
+	deallocator_t on_key_removal_fn;
+	struct hash_map_rcu_retired *retired; //array, in epoch order
+	size_t num_publishes;
+	struct hash_map_rcu_reader *readers; //HASH_MAP_RCU_MAX_READERS slots starting on a cache line
+	void *readers_allocation;
+};
+
+//one atomic load for the snapshot, the epoch store tells the writer what this reader might still see
+static inline struct hash_map *hash_map_rcu_read_begin(struct hash_map_rcu *rcu, struct hash_map_rcu_reader *reader)
+{
+	atomic_store(&reader->epoch, atomic_load(&rcu->epoch));
+	return atomic_load(&rcu->current);
+}
+
+static inline void hash_map_rcu_read_end(struct hash_map_rcu_reader *reader)
+{
+	atomic_store_explicit(&reader->epoch, 0, memory_order_release);
+}
+
+#ifndef HASH_MAP_RCU_IMPL
+extern struct hash_map_rcu *hash_map_rcu_create_data(size_t data_size, void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn);
+//no reader may be reading
+extern void hash_map_rcu_destroy(struct hash_map_rcu **rcup);
+extern void hash_map_rcu_set_on_key_removal(struct hash_map_rcu *rcu, deallocator_t fn);
+//NULL if all HASH_MAP_RCU_MAX_READERS slots are taken, a reader is used by one thread at a time
+extern struct hash_map_rcu_reader *hash_map_rcu_reader_register(struct hash_map_rcu *rcu);
+extern void hash_map_rcu_reader_unregister(struct hash_map_rcu_reader *reader);
+
+//writer only, these see the unpublished changes
+extern void *hash_map_rcu_find(struct hash_map_rcu *rcu, const char *key);
+//returns 1 if the key already exists (and doesn't insert), same as hash_map_insert
+extern int hash_map_rcu_insert_data(struct hash_map_rcu *rcu, const char *key, unsigned char *data, size_t data_size);
+//inserts or replaces the value, returns 1 if it replaced one
+extern int hash_map_rcu_set_data(struct hash_map_rcu *rcu, const char *key, unsigned char *data, size_t data_size);
+extern int hash_map_rcu_remove_key(struct hash_map_rcu *rcu, const char *key);
+extern void hash_map_rcu_publish(struct hash_map_rcu *rcu);
+//frees what no reader can see anymore, returns the number of retired pointers still waiting
+extern size_t hash_map_rcu_reclaim(struct hash_map_rcu *rcu);
+//waits for the readers and frees everything retired before the last publish
+extern void hash_map_rcu_synchronize(struct hash_map_rcu *rcu);
+#else
+
+static void *hash_map_rcu_allocate(struct hash_map *hm, size_t n)
+{
+	if(hm->custom_allocator_fn && hm->custom_allocator_userptr)
+		return hm->custom_allocator_fn(hm->custom_allocator_userptr, n);
+	return memory_allocate(n);
+}
+
+struct hash_map_rcu *hash_map_rcu_create_data(size_t data_size, void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn)
+{
+	struct hash_map_rcu *rcu = memory_allocate(sizeof(struct hash_map_rcu));
+	atomic_init(&rcu->current, hash_map_create_data(data_size, custom_allocator_userptr, custom_allocator_fn));
+	rcu->pending = NULL;
+	atomic_init(&rcu->epoch, 1);
+	rcu->on_key_removal_fn = NULL;
+	rcu->retired = NULL;
+	rcu->num_publishes = 0;
+	//memory_allocate only aligns like malloc, the padding keeps two readers off one line only if the slots start on one
+	rcu->readers_allocation = memory_allocate(sizeof(struct hash_map_rcu_reader) * HASH_MAP_RCU_MAX_READERS + 63);
+	rcu->readers = (struct hash_map_rcu_reader*)(((uintptr_t)rcu->readers_allocation + 63) & ~(uintptr_t)63);
+	for(int i = 0; i < HASH_MAP_RCU_MAX_READERS; ++i)
+	{
+		atomic_init(&rcu->readers[i].epoch, 0);
+		atomic_init(&rcu->readers[i].used, 0);
+	}
+	return rcu;
+}
+
+void hash_map_rcu_set_on_key_removal(struct hash_map_rcu *rcu, deallocator_t fn)
+{
+	rcu->on_key_removal_fn = fn;
+}
+
+struct hash_map_rcu_reader *hash_map_rcu_reader_register(struct hash_map_rcu *rcu)
+{
+	for(int i = 0; i < HASH_MAP_RCU_MAX_READERS; ++i)
+	{
+		int expected = 0;
+		if(atomic_compare_exchange_strong(&rcu->readers[i].used, &expected, 1))
+			return &rcu->readers[i];
+	}
+	return NULL;
+}
+
+void hash_map_rcu_reader_unregister(struct hash_map_rcu_reader *reader)
+{
+	atomic_store(&reader->epoch, 0);
+	atomic_store(&reader->used, 0);
+}
+
+static void hash_map_rcu_free_retired(struct hash_map_rcu *rcu, struct hash_map_rcu_retired *retired)
+{
+	if(retired->flags & HASH_MAP_RCU_FREE_VERSION)
+	{
+		struct hash_map *version = retired->ptr;
+		memory_deallocate(version->buckets);
+		memory_deallocate(version);
+		return;
+	}
+	struct hash_bucket_entry *entry = retired->ptr;
+	if((retired->flags & HASH_MAP_RCU_FINALIZE) && rcu->on_key_removal_fn)
+		rcu->on_key_removal_fn(entry->data);
+	if(retired->flags & HASH_MAP_RCU_FREE_KEY)
+		memory_deallocate(entry->key);
+	memory_deallocate(entry);
+}
+
+//pointers retired now can still be reached from the published snapshot, they get the current epoch
+//and only become free after the next publish moves the epoch past it
+static void hash_map_rcu_retire(struct hash_map_rcu *rcu, void *ptr, int flags)
+{
+	struct hash_map_rcu_retired retired = { ptr, atomic_load_explicit(&rcu->epoch, memory_order_relaxed), flags };
+	array_push(rcu->retired, retired);
+}
+
+size_t hash_map_rcu_reclaim(struct hash_map_rcu *rcu)
+{
+	size_t oldest = atomic_load(&rcu->epoch);
+	for(int i = 0; i < HASH_MAP_RCU_MAX_READERS; ++i)
+	{
+		size_t epoch = atomic_load(&rcu->readers[i].epoch);
+		if(epoch && epoch < oldest)
+			oldest = epoch;
+	}
+	//a reader that started in epoch e might hold any snapshot published before e was reached
+	size_t n = 0;
+	while(n < array_size(rcu->retired) && rcu->retired[n].epoch < oldest)
+		hash_map_rcu_free_retired(rcu, &rcu->retired[n++]);
+	if(n)
+		array_erase_n(rcu->retired, 0, n);
+	return array_size(rcu->retired);
+}
+
+void hash_map_rcu_synchronize(struct hash_map_rcu *rcu)
+{
+	size_t epoch = atomic_load(&rcu->epoch);
+	while(array_size(rcu->retired) && rcu->retired[0].epoch < epoch)
+	{
+		hash_map_rcu_reclaim(rcu);
+		thread_yield();
+	}
+}
+
+static void hash_map_rcu_free_entries(struct hash_map_rcu *rcu, struct hash_map *hm)
+{
+	for(size_t i = 0; i < hm->bucket_size; ++i)
+	{
+		struct hash_bucket_entry *cur = hm->buckets[i].head;
+		while(cur)
+		{
+			struct hash_bucket_entry *next = cur->next;
+			if(rcu->on_key_removal_fn)
+				rcu->on_key_removal_fn(cur->data);
+			memory_deallocate(cur->key);
+			memory_deallocate(cur);
+			cur = next;
+		}
+	}
+}
+
+void hash_map_rcu_destroy(struct hash_map_rcu **rcup)
+{
+	struct hash_map_rcu *rcu = *rcup;
+	for(size_t i = 0; i < array_size(rcu->retired); ++i)
+		hash_map_rcu_free_retired(rcu, &rcu->retired[i]);
+	array_free(rcu->retired);
+
+	//entries of the published snapshot are either shared with pending or were retired above
+	struct hash_map *current = atomic_load(&rcu->current);
+	hash_map_rcu_free_entries(rcu, rcu->pending ? rcu->pending : current);
+	if(rcu->pending)
+	{
+		memory_deallocate(rcu->pending->buckets);
+		memory_deallocate(rcu->pending);
+	}
+	memory_deallocate(current->buckets);
+	memory_deallocate(current);
+	memory_deallocate(rcu->readers_allocation);
+	memory_deallocate(rcu);
+	*rcup = NULL;
+}
+
+static struct hash_map *hash_map_rcu_view(struct hash_map_rcu *rcu)
+{
+	return rcu->pending ? rcu->pending : atomic_load_explicit(&rcu->current, memory_order_relaxed);
+}
+
+//the writer's version, its bucket array is private but the chains are shared with the snapshot
+static struct hash_map *hash_map_rcu_writable(struct hash_map_rcu *rcu)
+{
+	if(rcu->pending)
+		return rcu->pending;
+	struct hash_map *current = atomic_load_explicit(&rcu->current, memory_order_relaxed);
+	struct hash_map *hm = hash_map_rcu_allocate(current, sizeof(struct hash_map));
+	*hm = *current;
+	hm->buckets = hash_map_rcu_allocate(hm, sizeof(struct hash_bucket) * hm->bucket_size);
+	memcpy(hm->buckets, current->buckets, sizeof(struct hash_bucket) * hm->bucket_size);
+	rcu->pending = hm;
+	return hm;
+}
+
+static struct hash_bucket_entry *hash_map_rcu_find_entry(struct hash_map *hm, const char *key, unsigned long hashed_key)
+{
+	for(struct hash_bucket_entry *cur = hm->buckets[hashed_key % hm->bucket_size].head; cur; cur = cur->next)
+	{
+		if(cur->hash == hashed_key && !strcmp(cur->key, key))
+			return cur;
+	}
+	return NULL;
+}
+
+void *hash_map_rcu_find(struct hash_map_rcu *rcu, const char *key)
+{
+	struct hash_bucket_entry *entry = hash_map_rcu_find_entry(hash_map_rcu_view(rcu), key, hash_string(key));
+	return entry ? entry->data : NULL;
+}
+
+//the copy shares the key with the original
+static struct hash_bucket_entry *hash_map_rcu_copy_entry(struct hash_map *hm, struct hash_bucket_entry *entry)
+{
+	struct hash_bucket_entry *copy = hash_map_rcu_allocate(hm, sizeof(struct hash_bucket_entry) + hm->data_size);
+	memcpy(copy, entry, sizeof(struct hash_bucket_entry) + hm->data_size);
+	return copy;
+}
+
+//copies the entries in front of target, returns the (private) link pointing at target
+static struct hash_bucket_entry **hash_map_rcu_unshare(struct hash_map_rcu *rcu, struct hash_map *hm, struct hash_bucket *bucket, struct hash_bucket_entry *target)
+{
+	struct hash_bucket_entry **link = &bucket->head;
+	while(*link != target)
+	{
+		struct hash_bucket_entry *copy = hash_map_rcu_copy_entry(hm, *link);
+		hash_map_rcu_retire(rcu, *link, HASH_MAP_RCU_FREE_ENTRY);
+		*link = copy;
+		link = &copy->next;
+	}
+	return link;
+}
+
+//every chain is rebuilt, so every entry is copied
+static void hash_map_rcu_rehash(struct hash_map_rcu *rcu, struct hash_map *hm)
+{
+	unsigned long long start = std_time_ns();
+	size_t new_bucket_size = hm->bucket_size * 2;
+	struct hash_bucket *new_buckets = hash_map_rcu_allocate(hm, sizeof(struct hash_bucket) * new_bucket_size);
+	memset(new_buckets, 0, sizeof(struct hash_bucket) * new_bucket_size);
+	for(size_t i = 0; i < hm->bucket_size; ++i)
+	{
+		for(struct hash_bucket_entry *cur = hm->buckets[i].head; cur; cur = cur->next)
+		{
+			struct hash_bucket_entry *copy = hash_map_rcu_copy_entry(hm, cur);
+			struct hash_bucket *bucket = &new_buckets[cur->hash % new_bucket_size];
+			copy->next = bucket->head;
+			bucket->head = copy;
+			++bucket->size;
+			hash_map_rcu_retire(rcu, cur, HASH_MAP_RCU_FREE_ENTRY);
+		}
+	}
+	memory_deallocate(hm->buckets);
+	hm->buckets = new_buckets;
+	hm->bucket_size = new_bucket_size;
+	++hm->num_rehashes;
+	hm->rehash_ns += std_time_ns() - start;
+}
+
+static void hash_map_rcu_insert_new(struct hash_map_rcu *rcu, struct hash_map *hm, const char *key, unsigned long hashed_key, unsigned char *data)
+{
+	size_t kl = strlen(key);
+	struct hash_bucket_entry *entry = hash_map_rcu_allocate(hm, sizeof(struct hash_bucket_entry) + hm->data_size);
+	entry->hash = hashed_key;
+	entry->key = hash_map_rcu_allocate(hm, kl + 1);
+	memcpy(entry->key, key, kl + 1);
+	memcpy(entry->data, data, hm->data_size);
+
+	struct hash_bucket *bucket = &hm->buckets[hashed_key % hm->bucket_size];
+	entry->next = bucket->head;
+	bucket->head = entry;
+	++bucket->size;
+	if(++hm->num_entries >= HASH_LOAD_FACTOR * hm->bucket_size)
+		hash_map_rcu_rehash(rcu, hm);
+}
+
+int hash_map_rcu_insert_data(struct hash_map_rcu *rcu, const char *key, unsigned char *data, size_t data_size)
+{
+	unsigned long hashed_key = hash_string(key);
+	assert(data_size == hash_map_rcu_view(rcu)->data_size);
+	if(hash_map_rcu_find_entry(hash_map_rcu_view(rcu), key, hashed_key))
+		return 1;
+	hash_map_rcu_insert_new(rcu, hash_map_rcu_writable(rcu), key, hashed_key, data);
+	return 0;
+}
+
+int hash_map_rcu_set_data(struct hash_map_rcu *rcu, const char *key, unsigned char *data, size_t data_size)
+{
+	unsigned long hashed_key = hash_string(key);
+	struct hash_map *hm = hash_map_rcu_writable(rcu);
+	assert(data_size == hm->data_size);
+	struct hash_bucket_entry *entry = hash_map_rcu_find_entry(hm, key, hashed_key);
+	if(!entry)
+	{
+		hash_map_rcu_insert_new(rcu, hm, key, hashed_key, data);
+		return 0;
+	}
+	struct hash_bucket_entry **link = hash_map_rcu_unshare(rcu, hm, &hm->buckets[hashed_key % hm->bucket_size], entry);
+	struct hash_bucket_entry *copy = hash_map_rcu_copy_entry(hm, entry);
+	memcpy(copy->data, data, data_size);
+	*link = copy;
+	//the key moved to the copy, only the old value is finalized
+	hash_map_rcu_retire(rcu, entry, HASH_MAP_RCU_FREE_ENTRY | HASH_MAP_RCU_FINALIZE);
+	return 1;
+}
+
+int hash_map_rcu_remove_key(struct hash_map_rcu *rcu, const char *key)
+{
+	unsigned long hashed_key = hash_string(key);
+	if(!hash_map_rcu_find_entry(hash_map_rcu_view(rcu), key, hashed_key))
+		return 0;
+	struct hash_map *hm = hash_map_rcu_writable(rcu);
+	struct hash_bucket *bucket = &hm->buckets[hashed_key % hm->bucket_size];
+	struct hash_bucket_entry *entry = hash_map_rcu_find_entry(hm, key, hashed_key);
+	struct hash_bucket_entry **link = hash_map_rcu_unshare(rcu, hm, bucket, entry);
+	*link = entry->next;
+	--bucket->size;
+	--hm->num_entries;
+	hash_map_rcu_retire(rcu, entry, HASH_MAP_RCU_FREE_ENTRY | HASH_MAP_RCU_FREE_KEY | HASH_MAP_RCU_FINALIZE);
+	return 1;
+}
+
+void hash_map_rcu_publish(struct hash_map_rcu *rcu)
+{
+	if(!rcu->pending)
+		return;
+	struct hash_map *old = atomic_load_explicit(&rcu->current, memory_order_relaxed);
+	atomic_store(&rcu->current, rcu->pending);
+	rcu->pending = NULL;
+	hash_map_rcu_retire(rcu, old, HASH_MAP_RCU_FREE_VERSION);
+	//readers starting from here on can only load the new snapshot
+	atomic_fetch_add(&rcu->epoch, 1);
+	++rcu->num_publishes;
+	hash_map_rcu_reclaim(rcu);
+}
+#endif
+
+#define hash_map_rcu_create(type) \
+	hash_map_rcu_create_data(sizeof(type), NULL, NULL)
+#define hash_map_rcu_create_with_custom_allocator(type, userptr, allocator_fn) \
+	hash_map_rcu_create_data(sizeof(type), userptr, allocator_fn)
+#define hash_map_rcu_insert(rcu, key, value) \
+	hash_map_rcu_insert_data(rcu, key, (unsigned char*)&(value), sizeof(value))
+#define hash_map_rcu_set(rcu, key, value) \
+	hash_map_rcu_set_data(rcu, key, (unsigned char*)&(value), sizeof(value))
+#endif
@@ -0,0 +1,226 @@
+/*
+type specialized hash_map, same chaining, hash and growth policy as hash_map.h but the value type is known at compile time.
+values are copied by assignment and the key is stored in the entry, so an insert is one allocation.
+include once per value type (no include guard):
+
+#define HASH_MAP_TEMPLATE_NAME int_map
+#define HASH_MAP_TEMPLATE_TYPE int
+//optional, called with a pointer to the value when an entry is removed
+//#define HASH_MAP_TEMPLATE_FINALIZER(value) free(*(value))
+#include "hash_map_template.h"
+
+struct int_map *m = int_map_create();
+int_map_insert(m, "key", 123);
+int *v = int_map_find(m, "key");
+hash_map_template_foreach_entry(int_map, m, entry, { printf("%s %d\n", entry->key, entry->value); });
+int_map_destroy(&m);
+*/
+
+#ifndef HASH_MAP_TEMPLATE_NAME
+#error define HASH_MAP_TEMPLATE_NAME before including hash_map_template.h
+#endif
+#ifndef HASH_MAP_TEMPLATE_TYPE
+#error define HASH_MAP_TEMPLATE_TYPE before including hash_map_template.h
+#endif
+
+#include <string.h>
+#include "memory.h"
+#include "hash_string.h"
+
+#ifndef HASH_MAP_TEMPLATE_COMMON
+#define HASH_MAP_TEMPLATE_COMMON
+
+#ifndef HASH_BUCKET_SIZE
+#define HASH_BUCKET_SIZE (16)
+#endif
+#ifndef HASH_LOAD_FACTOR
+#define HASH_LOAD_FACTOR (1)
+#endif
+
+#define HASH_MAP_TEMPLATE_CAT_(a, b) a##_##b
+#define HASH_MAP_TEMPLATE_CAT(a, b) HASH_MAP_TEMPLATE_CAT_(a, b)
+
+//name is the HASH_MAP_TEMPLATE_NAME the map was generated with
+#define hash_map_template_foreach_entry(name, hm, entry, body) \
+	do { \
+		for(size_t i = 0; i < (hm)->bucket_size; ++i) \
+		{ \
+			struct HASH_MAP_TEMPLATE_CAT(name, entry) *entry = (hm)->buckets[i]; \
+			while(entry) \
+			{ \
+				body \
+				entry = entry->next; \
+			} \
+		} \
+	} while(0)
+#endif
+
+#define HMT_NAME HASH_MAP_TEMPLATE_NAME
+#define HMT_TYPE HASH_MAP_TEMPLATE_TYPE
+#define HMT_FN(fn) HASH_MAP_TEMPLATE_CAT(HMT_NAME, fn)
+#define HMT_ENTRY HASH_MAP_TEMPLATE_CAT(HMT_NAME, entry)
+
+struct HMT_ENTRY
+{
+	struct HMT_ENTRY *next;
+	unsigned long hash;
+	HMT_TYPE value;
+	char key[];
+};
+
+struct HMT_NAME
+{
+	struct HMT_ENTRY **buckets;
+	size_t bucket_size;
+	size_t num_entries;
+	void *custom_allocator_userptr;
+	custom_allocator_fn_t custom_allocator_fn;
+};
+
+static inline void *HMT_FN(allocate_)(struct HMT_NAME *hm, size_t n)
+{
+	if(hm->custom_allocator_fn && hm->custom_allocator_userptr)
+		return hm->custom_allocator_fn(hm->custom_allocator_userptr, n);
+	return memory_allocate(n);
+}
+
+static inline struct HMT_ENTRY **HMT_FN(allocate_buckets_)(struct HMT_NAME *hm, size_t num_buckets)
+{
+	struct HMT_ENTRY **buckets = HMT_FN(allocate_)(hm, sizeof(struct HMT_ENTRY*) * num_buckets);
+	memset(buckets, 0, sizeof(struct HMT_ENTRY*) * num_buckets);
+	return buckets;
+}
+
+static inline struct HMT_NAME *HMT_FN(create_with_custom_allocator)(void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn)
+{
+	struct HMT_NAME *hm = NULL;
+	if(custom_allocator_fn && custom_allocator_userptr)
+		hm = custom_allocator_fn(custom_allocator_userptr, sizeof(struct HMT_NAME));
+	else
+		hm = memory_allocate(sizeof(struct HMT_NAME));
+	hm->custom_allocator_userptr = custom_allocator_userptr;
+	hm->custom_allocator_fn = custom_allocator_fn;
+	hm->num_entries = 0;
+	hm->bucket_size = HASH_BUCKET_SIZE;
+	hm->buckets = HMT_FN(allocate_buckets_)(hm, HASH_BUCKET_SIZE);
+	return hm;
+}
+
+static inline struct HMT_NAME *HMT_FN(create)(void)
+{
+	return HMT_FN(create_with_custom_allocator)(NULL, NULL);
+}
+
+static inline void HMT_FN(free_entry_)(struct HMT_ENTRY *entry)
+{
+#ifdef HASH_MAP_TEMPLATE_FINALIZER
+	HASH_MAP_TEMPLATE_FINALIZER(&entry->value);
+#endif
+	memory_deallocate(entry);
+}
+
+static inline void HMT_FN(destroy)(struct HMT_NAME **hmp)
+{
+	struct HMT_NAME *hm = *hmp;
+	if(!hm)
+		return;
+	for(size_t i = 0; i < hm->bucket_size; ++i)
+	{
+		struct HMT_ENTRY *cur = hm->buckets[i];
+		while(cur)
+		{
+			struct HMT_ENTRY *next = cur->next;
+			HMT_FN(free_entry_)(cur);
+			cur = next;
+		}
+	}
+	memory_deallocate(hm->buckets);
+	memory_deallocate(hm);
+	*hmp = NULL;
+}
+
+static inline struct HMT_ENTRY *HMT_FN(find_entry_)(struct HMT_NAME *hm, const char *key, unsigned long hashed_key)
+{
+	for(struct HMT_ENTRY *cur = hm->buckets[hashed_key % hm->bucket_size]; cur; cur = cur->next)
+	{
+		if(cur->hash == hashed_key && !strcmp(cur->key, key))
+			return cur;
+	}
+	return NULL;
+}
+
+static inline HMT_TYPE *HMT_FN(find)(struct HMT_NAME *hm, const char *key)
+{
+	struct HMT_ENTRY *entry = HMT_FN(find_entry_)(hm, key, hash_string(key));
+	return entry ? &entry->value : NULL;
+}
+
+//entries are relinked, not copied
+static inline void HMT_FN(rehash_)(struct HMT_NAME *hm)
+{
+	size_t new_bucket_size = hm->bucket_size * 2;
+	struct HMT_ENTRY **new_buckets = HMT_FN(allocate_buckets_)(hm, new_bucket_size);
+	for(size_t i = 0; i < hm->bucket_size; ++i)
+	{
+		struct HMT_ENTRY *cur = hm->buckets[i];
+		while(cur)
+		{
+			struct HMT_ENTRY *next = cur->next;
+			struct HMT_ENTRY **head = &new_buckets[cur->hash % new_bucket_size];
+			cur->next = *head;
+			*head = cur;
+			cur = next;
+		}
+	}
+	memory_deallocate(hm->buckets);
+	hm->buckets = new_buckets;
+	hm->bucket_size = new_bucket_size;
+}
+
+//returns 1 if the key already exists (and doesn't insert), same as hash_map_insert
+static inline int HMT_FN(insert)(struct HMT_NAME *hm, const char *key, HMT_TYPE value)
+{
+	unsigned long hashed_key = hash_string(key);
+	if(HMT_FN(find_entry_)(hm, key, hashed_key))
+		return 1;
+
+	size_t kl = strlen(key);
+	struct HMT_ENTRY *entry = HMT_FN(allocate_)(hm, sizeof(struct HMT_ENTRY) + kl + 1);
+	entry->hash = hashed_key;
+	entry->value = value;
+	memcpy(entry->key, key, kl + 1);
+
+	struct HMT_ENTRY **head = &hm->buckets[hashed_key % hm->bucket_size];
+	entry->next = *head;
+	*head = entry;
+
+	if(++hm->num_entries >= HASH_LOAD_FACTOR * hm->bucket_size)
+		HMT_FN(rehash_)(hm);
+	return 0;
+}
+
+static inline int HMT_FN(remove_key)(struct HMT_NAME *hm, const char *key)
+{
+	unsigned long hashed_key = hash_string(key);
+	struct HMT_ENTRY **cur = &hm->buckets[hashed_key % hm->bucket_size];
+	for(; *cur; cur = &(*cur)->next)
+	{
+		struct HMT_ENTRY *entry = *cur;
+		if(entry->hash == hashed_key && !strcmp(entry->key, key))
+		{
+			*cur = entry->next;
+			HMT_FN(free_entry_)(entry);
+			--hm->num_entries;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+#undef HMT_NAME
+#undef HMT_TYPE
+#undef HMT_FN
+#undef HMT_ENTRY
+#undef HASH_MAP_TEMPLATE_NAME
+#undef HASH_MAP_TEMPLATE_TYPE
+#undef HASH_MAP_TEMPLATE_FINALIZER
@@ -1,6 +1,8 @@
 #ifndef HASH_STRING
 #define HASH_STRING
 
+#include <stddef.h>
+
 //http://www.cse.yorku.ca/~oz/hash.html
 static inline unsigned long
 hash_buffer(unsigned char *str)
@@ -14,7 +16,20 @@ hash_buffer(unsigned char *str)
     return hash;
 }
 
+//same hash as hash_buffer for a string of length n, no terminator needed
+static inline unsigned long
+hash_buffer_n(const unsigned char *buf, size_t n)
+{
+    unsigned long hash = 5381;
+
+    for (size_t i = 0; i < n; ++i)
+        hash = ((hash << 5) + hash) + buf[i]; /* hash * 33 + c */
+
+    return hash;
+}
+
 #define hash_string(str) hash_buffer((unsigned char*)str)
+#define hash_string_n(str, n) hash_buffer_n((const unsigned char*)str, n)
 
 typedef unsigned long hash_t;
 
@@ -2,6 +2,7 @@
 #define HEAP_STRING_H
 
 #include "std.h"
+#include "memory.h"
 #include <stdio.h> //vsnprintf
 #include <malloc.h>
 #include <string.h>
@@ -39,7 +40,7 @@ heap_string heap_string_read_from_text_file( const char* filename );
 #else
 heap_string heap_string_alloc(int n)
 {
-	struct heap_string_header *d = (struct heap_string_header*)malloc(sizeof(struct heap_string_header) + n + 1);
+	struct heap_string_header *d = (struct heap_string_header*)memory_allocate(sizeof(struct heap_string_header) + n + 1);
 	d->capacity = n;
 	d->size = 0;
 	return (heap_string)&d->buf[0];
@@ -71,7 +72,7 @@ heap_string heap_string_read_from_text_file( const char* filename )
 heap_string heap_string_new(const char* s)
 {
 	int strsz = strlen(s);
-	struct heap_string_header *d = (struct heap_string_header*)malloc(sizeof(struct heap_string_header) + strsz + 1);
+	struct heap_string_header *d = (struct heap_string_header*)memory_allocate(sizeof(struct heap_string_header) + strsz + 1);
 	d->capacity = strsz;
 	d->size = d->capacity;
 	memcpy(d->buf, s, strsz + 1);
@@ -85,7 +86,7 @@ void heap_string_free(heap_string *s)
 	if (!*s)
 		return;
 	struct heap_string_header *hdr = HEAP_STRING_HDR(*s);
-	free(hdr);
+	memory_deallocate(hdr);
 	*s = NULL;
 }
 
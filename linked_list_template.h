@@ -0,0 +1,187 @@
+/*
+type specialized linked_list, the node holds the value directly and append uses the tail instead of walking the list.
+include once per value type (no include guard):
+
+#define LINKED_LIST_TEMPLATE_NAME vec3_list
+#define LINKED_LIST_TEMPLATE_TYPE struct vec3
+//optional, called with a pointer to the value when a node is erased
+//#define LINKED_LIST_TEMPLATE_FINALIZER(value) free((value)->name)
+#include "linked_list_template.h"
+
+struct vec3_list *l = vec3_list_create();
+vec3_list_append(l, (struct vec3){1, 2, 3});
+linked_list_template_foreach(vec3_list, l, node, { printf("%f\n", node->value.x); });
+vec3_list_destroy(&l);
+*/
+
+#ifndef LINKED_LIST_TEMPLATE_NAME
+#error define LINKED_LIST_TEMPLATE_NAME before including linked_list_template.h
+#endif
+#ifndef LINKED_LIST_TEMPLATE_TYPE
+#error define LINKED_LIST_TEMPLATE_TYPE before including linked_list_template.h
+#endif
+
+#include <stddef.h>
+#include "memory.h"
+
+#ifndef LINKED_LIST_TEMPLATE_COMMON
+#define LINKED_LIST_TEMPLATE_COMMON
+
+#define LINKED_LIST_TEMPLATE_CAT_(a, b) a##_##b
+#define LINKED_LIST_TEMPLATE_CAT(a, b) LINKED_LIST_TEMPLATE_CAT_(a, b)
+
+//name is the LINKED_LIST_TEMPLATE_NAME the list was generated with, node can be erased in body
+#define linked_list_template_foreach(name, list, node, body) \
+	do { \
+	struct LINKED_LIST_TEMPLATE_CAT(name, node) *next_ = (list) ? (list)->head : NULL; \
+	while(next_ != NULL) \
+	{ \
+		struct LINKED_LIST_TEMPLATE_CAT(name, node) *node = next_; \
+		next_ = next_->next; \
+		body \
+	} \
+	} while(0)
+#define linked_list_template_reversed_foreach(name, list, node, body) \
+	do { \
+	struct LINKED_LIST_TEMPLATE_CAT(name, node) *prev_ = (list) ? (list)->tail : NULL; \
+	while(prev_ != NULL) \
+	{ \
+		struct LINKED_LIST_TEMPLATE_CAT(name, node) *node = prev_; \
+		prev_ = prev_->prev; \
+		body \
+	} \
+	} while(0)
+#endif
+
+#define LLT_NAME LINKED_LIST_TEMPLATE_NAME
+#define LLT_TYPE LINKED_LIST_TEMPLATE_TYPE
+#define LLT_FN(fn) LINKED_LIST_TEMPLATE_CAT(LLT_NAME, fn)
+#define LLT_NODE LINKED_LIST_TEMPLATE_CAT(LLT_NAME, node)
+
+struct LLT_NODE
+{
+	struct LLT_NODE *next;
+	struct LLT_NODE *prev;
+	LLT_TYPE value;
+};
+
+struct LLT_NAME
+{
+	struct LLT_NODE *head;
+	struct LLT_NODE *tail;
+	void *custom_allocator_userptr;
+	custom_allocator_fn_t custom_allocator_fn;
+};
+
+static inline void LLT_FN(init)(struct LLT_NAME *list)
+{
+	list->head = NULL;
+	list->tail = NULL;
+	list->custom_allocator_userptr = NULL;
+	list->custom_allocator_fn = NULL;
+}
+
+static inline struct LLT_NAME *LLT_FN(create_with_custom_allocator)(void *userptr, custom_allocator_fn_t allocator_fn)
+{
+	struct LLT_NAME *list = allocator_fn(userptr, sizeof(struct LLT_NAME));
+	LLT_FN(init)(list);
+	list->custom_allocator_userptr = userptr;
+	list->custom_allocator_fn = allocator_fn;
+	return list;
+}
+
+static inline struct LLT_NAME *LLT_FN(create)(void)
+{
+	struct LLT_NAME *list = memory_allocate(sizeof(struct LLT_NAME));
+	LLT_FN(init)(list);
+	return list;
+}
+
+static inline struct LLT_NODE *LLT_FN(create_node_)(struct LLT_NAME *list, LLT_TYPE value)
+{
+	struct LLT_NODE *n = NULL;
+	if(list->custom_allocator_fn && list->custom_allocator_userptr)
+		n = list->custom_allocator_fn(list->custom_allocator_userptr, sizeof(struct LLT_NODE));
+	else
+		n = memory_allocate(sizeof(struct LLT_NODE));
+	n->next = NULL;
+	n->prev = NULL;
+	n->value = value;
+	return n;
+}
+
+static inline LLT_TYPE *LLT_FN(prepend)(struct LLT_NAME *list, LLT_TYPE value)
+{
+	struct LLT_NODE *n = LLT_FN(create_node_)(list, value);
+	n->next = list->head;
+	if(list->head)
+		list->head->prev = n;
+	else
+		list->tail = n;
+	list->head = n;
+	return &n->value;
+}
+
+static inline LLT_TYPE *LLT_FN(append)(struct LLT_NAME *list, LLT_TYPE value)
+{
+	struct LLT_NODE *n = LLT_FN(create_node_)(list, value);
+	n->prev = list->tail;
+	if(list->tail)
+		list->tail->next = n;
+	else
+		list->head = n;
+	list->tail = n;
+	return &n->value;
+}
+
+static inline int LLT_FN(erase_node)(struct LLT_NAME *list, struct LLT_NODE *node)
+{
+	if(!list || !node)
+		return 1;
+	if(node->prev)
+		node->prev->next = node->next;
+	else
+		list->head = node->next;
+	if(node->next)
+		node->next->prev = node->prev;
+	else
+		list->tail = node->prev;
+#ifdef LINKED_LIST_TEMPLATE_FINALIZER
+	LINKED_LIST_TEMPLATE_FINALIZER(&node->value);
+#endif
+	memory_deallocate(node);
+	return 0;
+}
+
+static inline void LLT_FN(clear)(struct LLT_NAME *list)
+{
+	struct LLT_NODE *cur = list->head;
+	while(cur)
+	{
+		struct LLT_NODE *next = cur->next;
+#ifdef LINKED_LIST_TEMPLATE_FINALIZER
+		LINKED_LIST_TEMPLATE_FINALIZER(&cur->value);
+#endif
+		memory_deallocate(cur);
+		cur = next;
+	}
+	list->head = NULL;
+	list->tail = NULL;
+}
+
+static inline void LLT_FN(destroy)(struct LLT_NAME **plist)
+{
+	if(!*plist)
+		return;
+	LLT_FN(clear)(*plist);
+	memory_deallocate(*plist);
+	*plist = NULL;
+}
+
+#undef LLT_NAME
+#undef LLT_TYPE
+#undef LLT_FN
+#undef LLT_NODE
+#undef LINKED_LIST_TEMPLATE_NAME
+#undef LINKED_LIST_TEMPLATE_TYPE
+#undef LINKED_LIST_TEMPLATE_FINALIZER
@@ -0,0 +1,560 @@
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include "memory.h"
+#include "hash_string.h"
+#include "thread.h"
+
+/*
+bounded least recently used cache with string keys, limited by entry count, bytes or both.
+one node holds the hash chain link, the recency links, the value and (if it's short) the key,
+nodes come from a pool that grows in slabs and get reused after an eviction, so a full cache doesn't allocate.
+
+struct lru_cache *cache = lru_cache_create(struct texture*, 1024, 0); //at most 1024 entries, no byte limit
+lru_cache_set_on_key_removal(cache, texture_release); //called with a pointer to the value when an entry is evicted, replaced or removed
+lru_cache_put(cache, "grass.png", texture);
+struct texture **t = lru_cache_get(cache, "grass.png"); //marks it as the most recently used, NULL on a miss
+
+the byte limit counts the node (and a key too long to be stored in it), lru_cache_put_bytes adds what the value owns.
+pointers from get stay valid until the entry is evicted or removed.
+
+lru_cache_sharded splits the keys over independently locked caches for use from several threads,
+get copies the value out while the shard is locked.
+*/
+
+#define LRU_CACHE_INLINE_KEY_SIZE (32) //keys of this length or longer get their own allocation
+#define LRU_CACHE_BUCKET_SIZE (16)
+#define LRU_CACHE_SLAB_MIN_ENTRIES (64)
+
+#pragma warning( push )
+#pragma warning( disable : 4200 )
+struct lru_cache_entry
+{
+	struct lru_cache_entry *next; //hash chain, or the free list
+	struct lru_cache_entry *newer;
+	struct lru_cache_entry *older;
+	unsigned long hash;
+	size_t bytes;
+	char *key; //the inline key after the value, or an allocation of its own
+	unsigned char data[]; //the value, then LRU_CACHE_INLINE_KEY_SIZE bytes for the key
+};
+
+struct lru_cache_slab
+{
+	struct lru_cache_slab *next;
+	size_t num_entries;
+	unsigned char entries[];
+};
+#pragma warning( pop )
+
+struct lru_cache_stats
+{
+	size_t entries;
+	size_t bytes;
+	size_t hits;
+	size_t misses;
+	size_t evictions; //removed to stay within the limits, not counting lru_cache_remove_key
+	size_t pooled_entries; //nodes allocated, in use or free
+};
+
+struct lru_cache
+{
+	struct lru_cache_entry **buckets;
+	size_t bucket_size;
+	size_t data_size;
+	size_t entry_stride;
+	size_t num_entries;
+	size_t max_entries; //0 for no limit
+	size_t bytes;
+	size_t max_bytes; //0 for no limit
+
+	struct lru_cache_entry *newest;
+	struct lru_cache_entry *oldest;
+	struct lru_cache_entry *free_list;
+	struct lru_cache_slab *slabs;
+	size_t num_pooled;
+
+	deallocator_t on_key_removal_fn;
+	void *custom_allocator_userptr;
+	custom_allocator_fn_t custom_allocator_fn;
+
+	size_t hits;
+	size_t misses;
+	size_t evictions;
+};
+
+struct lru_cache_shard
+{
+	thread_mutex_t mutex;
+	struct lru_cache *cache;
+	char pad[64]; //keeps the locks of neighbouring shards off the same cache line
+};
+
+struct lru_cache_sharded
+{
+	struct lru_cache_shard *shards;
+	size_t num_shards;
+	size_t data_size;
+};
+
+#define lru_cache_entry_value(entry) ((void*)(entry)->data)
+
+//oldest to newest, body must not change the cache
+#define lru_cache_foreach_entry(cache, entry, body) \
+	do { \
+		for(struct lru_cache_entry *entry = (cache)->oldest; entry; entry = entry->newer) \
+		{ \
+			body \
+		} \
+	} while(0)
+
+#ifndef LRU_CACHE_IMPL
+extern struct lru_cache *lru_cache_create_data(size_t data_size, size_t max_entries, size_t max_bytes, void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn);
+extern void lru_cache_destroy(struct lru_cache **cachep);
+extern void lru_cache_set_on_key_removal(struct lru_cache *cache, deallocator_t fn);
+extern void *lru_cache_get(struct lru_cache *cache, const char *key);
+//doesn't count as a use or a hit
+extern void *lru_cache_peek(struct lru_cache *cache, const char *key);
+//extra_bytes is added to the entry's size for max_bytes, returns 1 if it replaced the value of an existing key
+extern int lru_cache_put_data(struct lru_cache *cache, const char *key, unsigned char *data, size_t data_size, size_t extra_bytes);
+extern int lru_cache_remove_key(struct lru_cache *cache, const char *key);
+extern void lru_cache_clear(struct lru_cache *cache);
+extern void lru_cache_stats(struct lru_cache *cache, struct lru_cache_stats *stats);
+
+//num_shards <= 0 uses the number of cores, the limits are split evenly between the shards
+extern struct lru_cache_sharded *lru_cache_sharded_create_data(size_t data_size, int num_shards, size_t max_entries, size_t max_bytes, void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn);
+extern void lru_cache_sharded_destroy(struct lru_cache_sharded **cachep);
+extern void lru_cache_sharded_set_on_key_removal(struct lru_cache_sharded *cache, deallocator_t fn);
+//copies the value to out, returns 1 on a hit
+extern int lru_cache_sharded_get_data(struct lru_cache_sharded *cache, const char *key, void *out, size_t data_size);
+extern int lru_cache_sharded_put_data(struct lru_cache_sharded *cache, const char *key, unsigned char *data, size_t data_size, size_t extra_bytes);
+extern int lru_cache_sharded_remove_key(struct lru_cache_sharded *cache, const char *key);
+//summed over the shards
+extern void lru_cache_sharded_stats(struct lru_cache_sharded *cache, struct lru_cache_stats *stats);
+#else
+
+static void *lru_cache_allocate(struct lru_cache *cache, size_t n)
+{
+	if(cache->custom_allocator_fn && cache->custom_allocator_userptr)
+		return cache->custom_allocator_fn(cache->custom_allocator_userptr, n);
+	return memory_allocate(n);
+}
+
+static struct lru_cache_entry **lru_cache_allocate_buckets(struct lru_cache *cache, size_t num_buckets)
+{
+	struct lru_cache_entry **buckets = lru_cache_allocate(cache, sizeof(struct lru_cache_entry*) * num_buckets);
+	memset(buckets, 0, sizeof(struct lru_cache_entry*) * num_buckets);
+	return buckets;
+}
+
+struct lru_cache *lru_cache_create_data(size_t data_size, size_t max_entries, size_t max_bytes, void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn)
+{
+	struct lru_cache *cache = NULL;
+	if(custom_allocator_fn && custom_allocator_userptr)
+		cache = custom_allocator_fn(custom_allocator_userptr, sizeof(struct lru_cache));
+	else
+		cache = memory_allocate(sizeof(struct lru_cache));
+	cache->custom_allocator_userptr = custom_allocator_userptr;
+	cache->custom_allocator_fn = custom_allocator_fn;
+	cache->data_size = data_size;
+	//value and inline key after the header, nodes stay aligned like malloc's
+	cache->entry_stride = (sizeof(struct lru_cache_entry) + ((data_size + 7) & ~(size_t)7) + LRU_CACHE_INLINE_KEY_SIZE + 15) & ~(size_t)15;
+	cache->num_entries = 0;
+	cache->max_entries = max_entries;
+	cache->bytes = 0;
+	cache->max_bytes = max_bytes;
+	cache->newest = NULL;
+	cache->oldest = NULL;
+	cache->free_list = NULL;
+	cache->slabs = NULL;
+	cache->num_pooled = 0;
+	cache->on_key_removal_fn = NULL;
+	cache->hits = 0;
+	cache->misses = 0;
+	cache->evictions = 0;
+	//a count limited cache never needs more buckets than entries
+	cache->bucket_size = LRU_CACHE_BUCKET_SIZE;
+	while(cache->bucket_size < max_entries)
+		cache->bucket_size *= 2;
+	cache->buckets = lru_cache_allocate_buckets(cache, cache->bucket_size);
+	return cache;
+}
+
+void lru_cache_set_on_key_removal(struct lru_cache *cache, deallocator_t fn)
+{
+	cache->on_key_removal_fn = fn;
+}
+
+static int lru_cache_key_is_inline(struct lru_cache *cache, struct lru_cache_entry *entry)
+{
+	return entry->key == (char*)&entry->data[(cache->data_size + 7) & ~(size_t)7];
+}
+
+//the caller unlinks the entry, it goes back to the pool
+static void lru_cache_release_entry(struct lru_cache *cache, struct lru_cache_entry *entry)
+{
+	if(cache->on_key_removal_fn)
+		cache->on_key_removal_fn(entry->data);
+	if(!lru_cache_key_is_inline(cache, entry))
+		memory_deallocate(entry->key);
+	cache->bytes -= entry->bytes;
+	--cache->num_entries;
+	entry->next = cache->free_list;
+	cache->free_list = entry;
+}
+
+void lru_cache_clear(struct lru_cache *cache)
+{
+	struct lru_cache_entry *cur = cache->oldest;
+	while(cur)
+	{
+		struct lru_cache_entry *newer = cur->newer;
+		lru_cache_release_entry(cache, cur);
+		cur = newer;
+	}
+	memset(cache->buckets, 0, sizeof(struct lru_cache_entry*) * cache->bucket_size);
+	cache->newest = NULL;
+	cache->oldest = NULL;
+}
+
+void lru_cache_destroy(struct lru_cache **cachep)
+{
+	struct lru_cache *cache = *cachep;
+	if(!cache)
+		return;
+	lru_cache_clear(cache);
+	struct lru_cache_slab *slab = cache->slabs;
+	while(slab)
+	{
+		struct lru_cache_slab *next = slab->next;
+		memory_deallocate(slab);
+		slab = next;
+	}
+	memory_deallocate(cache->buckets);
+	memory_deallocate(cache);
+	*cachep = NULL;
+}
+
+//doubles the pool, never past max_entries (+ 1, an entry is inserted before the oldest is evicted)
+static void lru_cache_grow_pool(struct lru_cache *cache)
+{
+	size_t n = cache->num_pooled > LRU_CACHE_SLAB_MIN_ENTRIES ? cache->num_pooled : LRU_CACHE_SLAB_MIN_ENTRIES;
+	if(cache->max_entries && cache->num_pooled + n > cache->max_entries + 1)
+		n = cache->max_entries + 1 - cache->num_pooled;
+	struct lru_cache_slab *slab = lru_cache_allocate(cache, sizeof(struct lru_cache_slab) + cache->entry_stride * n);
+	slab->num_entries = n;
+	slab->next = cache->slabs;
+	cache->slabs = slab;
+	for(size_t i = n; i-- > 0;)
+	{
+		struct lru_cache_entry *entry = (struct lru_cache_entry*)&slab->entries[i * cache->entry_stride];
+		entry->next = cache->free_list;
+		cache->free_list = entry;
+	}
+	cache->num_pooled += n;
+}
+
+static struct lru_cache_entry **lru_cache_find_link(struct lru_cache *cache, const char *key, unsigned long hashed_key)
+{
+	struct lru_cache_entry **link = &cache->buckets[hashed_key % cache->bucket_size];
+	for(; *link; link = &(*link)->next)
+	{
+		if((*link)->hash == hashed_key && !strcmp((*link)->key, key))
+			return link;
+	}
+	return NULL;
+}
+
+static void lru_cache_unlink_recency(struct lru_cache *cache, struct lru_cache_entry *entry)
+{
+	if(entry->newer)
+		entry->newer->older = entry->older;
+	else
+		cache->newest = entry->older;
+	if(entry->older)
+		entry->older->newer = entry->newer;
+	else
+		cache->oldest = entry->newer;
+}
+
+static void lru_cache_link_newest(struct lru_cache *cache, struct lru_cache_entry *entry)
+{
+	entry->newer = NULL;
+	entry->older = cache->newest;
+	if(cache->newest)
+		cache->newest->newer = entry;
+	else
+		cache->oldest = entry;
+	cache->newest = entry;
+}
+
+static void lru_cache_touch(struct lru_cache *cache, struct lru_cache_entry *entry)
+{
+	if(cache->newest == entry)
+		return;
+	lru_cache_unlink_recency(cache, entry);
+	lru_cache_link_newest(cache, entry);
+}
+
+static void *lru_cache_get_hashed(struct lru_cache *cache, const char *key, unsigned long hashed_key)
+{
+	struct lru_cache_entry **link = lru_cache_find_link(cache, key, hashed_key);
+	if(!link)
+	{
+		++cache->misses;
+		return NULL;
+	}
+	++cache->hits;
+	lru_cache_touch(cache, *link);
+	return (*link)->data;
+}
+
+void *lru_cache_get(struct lru_cache *cache, const char *key)
+{
+	return lru_cache_get_hashed(cache, key, hash_string(key));
+}
+
+void *lru_cache_peek(struct lru_cache *cache, const char *key)
+{
+	struct lru_cache_entry **link = lru_cache_find_link(cache, key, hash_string(key));
+	return link ? (*link)->data : NULL;
+}
+
+static void lru_cache_remove_entry(struct lru_cache *cache, struct lru_cache_entry **link)
+{
+	struct lru_cache_entry *entry = *link;
+	*link = entry->next;
+	lru_cache_unlink_recency(cache, entry);
+	lru_cache_release_entry(cache, entry);
+}
+
+static int lru_cache_remove_hashed(struct lru_cache *cache, const char *key, unsigned long hashed_key)
+{
+	struct lru_cache_entry **link = lru_cache_find_link(cache, key, hashed_key);
+	if(!link)
+		return 0;
+	lru_cache_remove_entry(cache, link);
+	return 1;
+}
+
+int lru_cache_remove_key(struct lru_cache *cache, const char *key)
+{
+	return lru_cache_remove_hashed(cache, key, hash_string(key));
+}
+
+static void lru_cache_evict_oldest(struct lru_cache *cache)
+{
+	struct lru_cache_entry *oldest = cache->oldest;
+	struct lru_cache_entry **link = &cache->buckets[oldest->hash % cache->bucket_size];
+	while(*link != oldest)
+		link = &(*link)->next;
+	lru_cache_remove_entry(cache, link);
+	++cache->evictions;
+}
+
+//only a cache limited by bytes grows its buckets, entries are relinked
+static void lru_cache_rehash(struct lru_cache *cache)
+{
+	size_t new_bucket_size = cache->bucket_size * 2;
+	struct lru_cache_entry **new_buckets = lru_cache_allocate_buckets(cache, new_bucket_size);
+	for(size_t i = 0; i < cache->bucket_size; ++i)
+	{
+		struct lru_cache_entry *cur = cache->buckets[i];
+		while(cur)
+		{
+			struct lru_cache_entry *next = cur->next;
+			struct lru_cache_entry **head = &new_buckets[cur->hash % new_bucket_size];
+			cur->next = *head;
+			*head = cur;
+			cur = next;
+		}
+	}
+	memory_deallocate(cache->buckets);
+	cache->buckets = new_buckets;
+	cache->bucket_size = new_bucket_size;
+}
+
+static int lru_cache_put_hashed(struct lru_cache *cache, const char *key, unsigned long hashed_key, unsigned char *data, size_t data_size, size_t extra_bytes)
+{
+	assert(data_size == cache->data_size);
+	struct lru_cache_entry **link = lru_cache_find_link(cache, key, hashed_key);
+	struct lru_cache_entry *entry = NULL;
+	int replaced = link != NULL;
+	if(replaced)
+	{
+		entry = *link;
+		if(cache->on_key_removal_fn)
+			cache->on_key_removal_fn(entry->data);
+		cache->bytes -= entry->bytes;
+		lru_cache_touch(cache, entry);
+	} else
+	{
+		if(!cache->free_list)
+			lru_cache_grow_pool(cache);
+		entry = cache->free_list;
+		cache->free_list = entry->next;
+
+		size_t kl = strlen(key);
+		entry->hash = hashed_key;
+		entry->key = (char*)&entry->data[(cache->data_size + 7) & ~(size_t)7];
+		if(kl >= LRU_CACHE_INLINE_KEY_SIZE)
+			entry->key = lru_cache_allocate(cache, kl + 1);
+		memcpy(entry->key, key, kl + 1);
+
+		struct lru_cache_entry **head = &cache->buckets[hashed_key % cache->bucket_size];
+		entry->next = *head;
+		*head = entry;
+		lru_cache_link_newest(cache, entry);
+		++cache->num_entries;
+	}
+	memcpy(entry->data, data, data_size);
+	entry->bytes = cache->entry_stride + extra_bytes;
+	if(!lru_cache_key_is_inline(cache, entry))
+		entry->bytes += strlen(entry->key) + 1;
+	cache->bytes += entry->bytes;
+
+	//the new entry stays even if it's over max_bytes on its own
+	while(cache->oldest != entry &&
+		((cache->max_entries && cache->num_entries > cache->max_entries) || (cache->max_bytes && cache->bytes > cache->max_bytes)))
+		lru_cache_evict_oldest(cache);
+
+	if(!cache->max_entries && cache->num_entries >= cache->bucket_size)
+		lru_cache_rehash(cache);
+	return replaced;
+}
+
+int lru_cache_put_data(struct lru_cache *cache, const char *key, unsigned char *data, size_t data_size, size_t extra_bytes)
+{
+	return lru_cache_put_hashed(cache, key, hash_string(key), data, data_size, extra_bytes);
+}
+
+void lru_cache_stats(struct lru_cache *cache, struct lru_cache_stats *stats)
+{
+	stats->entries = cache->num_entries;
+	stats->bytes = cache->bytes;
+	stats->hits = cache->hits;
+	stats->misses = cache->misses;
+	stats->evictions = cache->evictions;
+	stats->pooled_entries = cache->num_pooled;
+}
+
+struct lru_cache_sharded *lru_cache_sharded_create_data(size_t data_size, int num_shards, size_t max_entries, size_t max_bytes, void *custom_allocator_userptr, custom_allocator_fn_t custom_allocator_fn)
+{
+	if(num_shards <= 0)
+		num_shards = thread_hardware_concurrency();
+	struct lru_cache_sharded *cache = memory_allocate(sizeof(struct lru_cache_sharded));
+	cache->num_shards = num_shards;
+	cache->data_size = data_size;
+	cache->shards = memory_allocate(sizeof(struct lru_cache_shard) * num_shards);
+	for(int i = 0; i < num_shards; ++i)
+	{
+		thread_mutex_init(&cache->shards[i].mutex);
+		cache->shards[i].cache = lru_cache_create_data(data_size,
+			(max_entries + num_shards - 1) / num_shards,
+			(max_bytes + num_shards - 1) / num_shards,
+			custom_allocator_userptr, custom_allocator_fn);
+	}
+	return cache;
+}
+
+void lru_cache_sharded_destroy(struct lru_cache_sharded **cachep)
+{
+	struct lru_cache_sharded *cache = *cachep;
+	if(!cache)
+		return;
+	for(size_t i = 0; i < cache->num_shards; ++i)
+	{
+		lru_cache_destroy(&cache->shards[i].cache);
+		thread_mutex_destroy(&cache->shards[i].mutex);
+	}
+	memory_deallocate(cache->shards);
+	memory_deallocate(cache);
+	*cachep = NULL;
+}
+
+void lru_cache_sharded_set_on_key_removal(struct lru_cache_sharded *cache, deallocator_t fn)
+{
+	for(size_t i = 0; i < cache->num_shards; ++i)
+		lru_cache_set_on_key_removal(cache->shards[i].cache, fn);
+}
+
+//the shard comes from the high bits, the low ones pick the bucket inside it
+static struct lru_cache_shard *lru_cache_sharded_shard(struct lru_cache_sharded *cache, unsigned long hashed_key)
+{
+	uint64_t h = (uint64_t)hashed_key * 0x9E3779B97F4A7C15ULL;
+	return &cache->shards[(h >> 32) % cache->num_shards];
+}
+
+int lru_cache_sharded_get_data(struct lru_cache_sharded *cache, const char *key, void *out, size_t data_size)
+{
+	assert(data_size == cache->data_size);
+	unsigned long hashed_key = hash_string(key);
+	struct lru_cache_shard *shard = lru_cache_sharded_shard(cache, hashed_key);
+	thread_mutex_lock(&shard->mutex);
+	void *value = lru_cache_get_hashed(shard->cache, key, hashed_key);
+	if(value)
+		memcpy(out, value, data_size);
+	thread_mutex_unlock(&shard->mutex);
+	return value != NULL;
+}
+
+int lru_cache_sharded_put_data(struct lru_cache_sharded *cache, const char *key, unsigned char *data, size_t data_size, size_t extra_bytes)
+{
+	unsigned long hashed_key = hash_string(key);
+	struct lru_cache_shard *shard = lru_cache_sharded_shard(cache, hashed_key);
+	thread_mutex_lock(&shard->mutex);
+	int replaced = lru_cache_put_hashed(shard->cache, key, hashed_key, data, data_size, extra_bytes);
+	thread_mutex_unlock(&shard->mutex);
+	return replaced;
+}
+
+int lru_cache_sharded_remove_key(struct lru_cache_sharded *cache, const char *key)
+{
+	unsigned long hashed_key = hash_string(key);
+	struct lru_cache_shard *shard = lru_cache_sharded_shard(cache, hashed_key);
+	thread_mutex_lock(&shard->mutex);
+	int removed = lru_cache_remove_hashed(shard->cache, key, hashed_key);
+	thread_mutex_unlock(&shard->mutex);
+	return removed;
+}
+
+void lru_cache_sharded_stats(struct lru_cache_sharded *cache, struct lru_cache_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+	for(size_t i = 0; i < cache->num_shards; ++i)
+	{
+		struct lru_cache_stats shard_stats;
+		thread_mutex_lock(&cache->shards[i].mutex);
+		lru_cache_stats(cache->shards[i].cache, &shard_stats);
+		thread_mutex_unlock(&cache->shards[i].mutex);
+		stats->entries += shard_stats.entries;
+		stats->bytes += shard_stats.bytes;
+		stats->hits += shard_stats.hits;
+		stats->misses += shard_stats.misses;
+		stats->evictions += shard_stats.evictions;
+		stats->pooled_entries += shard_stats.pooled_entries;
+	}
+}
+#endif
+
+#define lru_cache_create(type, max_entries, max_bytes) \
+	lru_cache_create_data(sizeof(type), max_entries, max_bytes, NULL, NULL)
+#define lru_cache_create_with_custom_allocator(type, max_entries, max_bytes, userptr, allocator_fn) \
+	lru_cache_create_data(sizeof(type), max_entries, max_bytes, userptr, allocator_fn)
+#define lru_cache_put(cache, key, value) \
+	lru_cache_put_data(cache, key, (unsigned char*)&(value), sizeof(value), 0)
+#define lru_cache_put_bytes(cache, key, value, extra_bytes) \
+	lru_cache_put_data(cache, key, (unsigned char*)&(value), sizeof(value), extra_bytes)
+
+#define lru_cache_sharded_create(type, num_shards, max_entries, max_bytes) \
+	lru_cache_sharded_create_data(sizeof(type), num_shards, max_entries, max_bytes, NULL, NULL)
+#define lru_cache_sharded_get(cache, key, out) \
+	lru_cache_sharded_get_data(cache, key, &(out), sizeof(out))
+#define lru_cache_sharded_put(cache, key, value) \
+	lru_cache_sharded_put_data(cache, key, (unsigned char*)&(value), sizeof(value), 0)
+#define lru_cache_sharded_put_bytes(cache, key, value, extra_bytes) \
+	lru_cache_sharded_put_data(cache, key, (unsigned char*)&(value), sizeof(value), extra_bytes)
+#endif
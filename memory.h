@@ -3,12 +3,328 @@
 
 #include <malloc.h>
 #include <stddef.h>
+#include <string.h>
 
 typedef void*(*allocator_t)(size_t);
 typedef void(*deallocator_t)(void*);
 
 typedef void*(*custom_allocator_fn_t)(void *userptr, size_t nbytes);
 
+/*
+opt-in allocation tracking, compile everything with MEMORY_TRACKING defined and MEMORY_IMPL in one translation unit.
+
+memory_allocate/memory_deallocate then count towards memory_tag_default, a container can be attributed to its own tag
+by passing memory_tracking_allocate as its custom allocator:
+
+static struct memory_tag tag; //a tag is big (per thread slots) and stays in a global list, so not a local
+memory_tag_init(&tag, "meshes"); //initializing a tag that's already registered does nothing
+struct hash_map *hm = hash_map_create_with_custom_allocator(int, &tag, memory_tracking_allocate);
+...
+memory_tracking_dump(); //live/peak bytes, counts and a size histogram per tag
+hash_map_destroy(&hm);
+memory_tag_destroy(&tag); //takes it off the list, only once everything allocated with it is freed
+
+every allocation gets a small header with its tag and size so memory_deallocate knows what to credit,
+which means memory_deallocate can only free memory that came from memory_allocate or memory_tracking_allocate.
+without MEMORY_TRACKING the tag functions still exist but don't track anything.
+*/
+
+#define MEMORY_TRACKING_MAX_THREADS (64)
+#define MEMORY_TRACKING_SIZE_CLASSES (32) //class i holds sizes in (2^(i-1), 2^i]
+
+struct memory_tag_stats
+{
+	long long live_bytes;
+	long long peak_bytes;
+	long long live_allocations;
+	size_t allocations;
+	size_t deallocations;
+	size_t bytes_allocated;
+	size_t size_classes[MEMORY_TRACKING_SIZE_CLASSES]; //allocations per size class
+};
+
+#ifndef MEMORY_TRACKING
+
+struct memory_tag
+{
+	const char *name;
+};
+
 #define memory_allocate malloc
 #define memory_deallocate free
-#endif
\ No newline at end of file
+
+static inline void memory_tag_init(struct memory_tag *tag, const char *name)
+{
+	tag->name = name;
+}
+
+static inline void memory_tag_destroy(struct memory_tag *tag)
+{
+	(void)tag;
+}
+
+static inline void *memory_tracking_allocate(void *tag, size_t nbytes)
+{
+	(void)tag;
+	return malloc(nbytes);
+}
+
+static inline void memory_tag_stats(struct memory_tag *tag, struct memory_tag_stats *stats)
+{
+	(void)tag;
+	memset(stats, 0, sizeof(*stats));
+}
+
+static inline void memory_tracking_dump(void)
+{
+}
+#else
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define MEMORY_THREAD_LOCAL __declspec(thread)
+#else
+#define MEMORY_THREAD_LOCAL _Thread_local
+#endif
+
+//each thread writes to its own slot (unless there are more than MEMORY_TRACKING_MAX_THREADS), merged when read
+struct memory_tag_slot
+{
+	atomic_llong live_bytes; //can go negative when memory is freed on another thread
+	atomic_llong peak_bytes;
+	atomic_size_t allocations;
+	atomic_size_t deallocations;
+	atomic_size_t bytes_allocated;
+	atomic_size_t size_classes[MEMORY_TRACKING_SIZE_CLASSES];
+};
+
+struct memory_tag
+{
+	const char *name;
+	struct memory_tag *next; //all tags, for memory_tracking_dump
+	atomic_llong peak_bytes; //sampled from the merged slots
+	struct memory_tag_slot slots[MEMORY_TRACKING_MAX_THREADS];
+};
+
+union memory_tracking_header
+{
+	struct
+	{
+		struct memory_tag *tag;
+		size_t size;
+	} info;
+	//keep the memory after the header aligned like malloc's
+	long double align_ld;
+	long long align_ll;
+	void *align_p;
+};
+
+#define memory_allocate memory_tracking_allocate_default
+#define memory_deallocate memory_tracking_deallocate
+
+#ifndef MEMORY_IMPL
+extern struct memory_tag memory_tag_default;
+extern void memory_tag_init(struct memory_tag *tag, const char *name);
+extern void memory_tag_destroy(struct memory_tag *tag);
+extern void *memory_tracking_allocate(void *tag, size_t nbytes);
+extern void *memory_tracking_allocate_default(size_t nbytes);
+extern void memory_tracking_deallocate(void *p);
+extern void memory_tag_stats(struct memory_tag *tag, struct memory_tag_stats *stats);
+extern void memory_tracking_dump(void);
+#else
+
+struct memory_tag memory_tag_default = { .name = "default" };
+static struct memory_tag *memory_tags = NULL;
+static atomic_flag memory_tags_lock = ATOMIC_FLAG_INIT; //registering and dumping are rare, a spinlock is enough
+static atomic_int memory_tracking_next_slot = 0;
+static MEMORY_THREAD_LOCAL int memory_tracking_slot = -1;
+static atomic_int memory_tag_default_registered = 0;
+
+static void memory_tags_lock_acquire(void)
+{
+	while(atomic_flag_test_and_set_explicit(&memory_tags_lock, memory_order_acquire))
+	{
+	}
+}
+
+static void memory_tags_lock_release(void)
+{
+	atomic_flag_clear_explicit(&memory_tags_lock, memory_order_release);
+}
+
+//looked up in the list rather than flagged in the tag, an uninitialized tag can hold anything
+static int memory_tag_registered(struct memory_tag *tag)
+{
+	for(struct memory_tag *it = memory_tags; it; it = it->next)
+	{
+		if(it == tag)
+			return 1;
+	}
+	return 0;
+}
+
+//the default tag can be counted into before it's registered, so only memory_tag_init clears
+static void memory_tag_register(struct memory_tag *tag, const char *name, int clear)
+{
+	memory_tags_lock_acquire();
+	if(!memory_tag_registered(tag))
+	{
+		if(clear)
+			memset(tag, 0, sizeof(*tag));
+		tag->name = name;
+		tag->next = memory_tags;
+		memory_tags = tag;
+	}
+	memory_tags_lock_release();
+}
+
+void memory_tag_init(struct memory_tag *tag, const char *name)
+{
+	memory_tag_register(tag, name, 1);
+}
+
+void memory_tag_destroy(struct memory_tag *tag)
+{
+	memory_tags_lock_acquire();
+	for(struct memory_tag **it = &memory_tags; *it; it = &(*it)->next)
+	{
+		if(*it == tag)
+		{
+			*it = tag->next;
+			tag->next = NULL;
+			break;
+		}
+	}
+	memory_tags_lock_release();
+}
+
+static int memory_size_class(size_t size)
+{
+	int c = 0;
+	size_t s = 1;
+	while(s < size && c < MEMORY_TRACKING_SIZE_CLASSES - 1)
+	{
+		s <<= 1;
+		++c;
+	}
+	return c;
+}
+
+static struct memory_tag_slot *memory_tracking_get_slot(struct memory_tag *tag)
+{
+	if(memory_tracking_slot == -1)
+		memory_tracking_slot = atomic_fetch_add_explicit(&memory_tracking_next_slot, 1, memory_order_relaxed) % MEMORY_TRACKING_MAX_THREADS;
+	return &tag->slots[memory_tracking_slot];
+}
+
+static long long memory_tag_live_bytes(struct memory_tag *tag)
+{
+	long long live = 0;
+	for(int i = 0; i < MEMORY_TRACKING_MAX_THREADS; ++i)
+		live += atomic_load_explicit(&tag->slots[i].live_bytes, memory_order_relaxed);
+	return live;
+}
+
+static void memory_tag_sample_peak(struct memory_tag *tag)
+{
+	long long live = memory_tag_live_bytes(tag);
+	long long peak = atomic_load_explicit(&tag->peak_bytes, memory_order_relaxed);
+	while(live > peak && !atomic_compare_exchange_weak_explicit(&tag->peak_bytes, &peak, live, memory_order_relaxed, memory_order_relaxed))
+	{
+	}
+}
+
+void *memory_tracking_allocate(void *userptr, size_t nbytes)
+{
+	struct memory_tag *tag = userptr ? userptr : &memory_tag_default;
+	union memory_tracking_header *hdr = malloc(sizeof(union memory_tracking_header) + nbytes);
+	if(!hdr)
+		return NULL;
+	hdr->info.tag = tag;
+	hdr->info.size = nbytes;
+
+	struct memory_tag_slot *slot = memory_tracking_get_slot(tag);
+	long long live = atomic_fetch_add_explicit(&slot->live_bytes, (long long)nbytes, memory_order_relaxed) + (long long)nbytes;
+	if(live > atomic_load_explicit(&slot->peak_bytes, memory_order_relaxed))
+		atomic_store_explicit(&slot->peak_bytes, live, memory_order_relaxed);
+	size_t count = atomic_fetch_add_explicit(&slot->allocations, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&slot->bytes_allocated, nbytes, memory_order_relaxed);
+	atomic_fetch_add_explicit(&slot->size_classes[memory_size_class(nbytes)], 1, memory_order_relaxed);
+
+	//the tag wide peak is only sampled, every so often and for big allocations
+	if((count & 63) == 0 || nbytes >= 65536)
+		memory_tag_sample_peak(tag);
+	return hdr + 1;
+}
+
+static void memory_tag_default_register(void)
+{
+	if(!atomic_load_explicit(&memory_tag_default_registered, memory_order_relaxed) && !atomic_exchange(&memory_tag_default_registered, 1))
+		memory_tag_register(&memory_tag_default, "default", 0);
+}
+
+void *memory_tracking_allocate_default(size_t nbytes)
+{
+	memory_tag_default_register();
+	return memory_tracking_allocate(&memory_tag_default, nbytes);
+}
+
+void memory_tracking_deallocate(void *p)
+{
+	if(!p)
+		return;
+	union memory_tracking_header *hdr = (union memory_tracking_header*)p - 1;
+	struct memory_tag_slot *slot = memory_tracking_get_slot(hdr->info.tag);
+	atomic_fetch_sub_explicit(&slot->live_bytes, (long long)hdr->info.size, memory_order_relaxed);
+	atomic_fetch_add_explicit(&slot->deallocations, 1, memory_order_relaxed);
+	free(hdr);
+}
+
+void memory_tag_stats(struct memory_tag *tag, struct memory_tag_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+	memory_tag_sample_peak(tag);
+	long long max_slot_peak = 0;
+	for(int i = 0; i < MEMORY_TRACKING_MAX_THREADS; ++i)
+	{
+		struct memory_tag_slot *slot = &tag->slots[i];
+		stats->live_bytes += atomic_load_explicit(&slot->live_bytes, memory_order_relaxed);
+		stats->allocations += atomic_load_explicit(&slot->allocations, memory_order_relaxed);
+		stats->deallocations += atomic_load_explicit(&slot->deallocations, memory_order_relaxed);
+		stats->bytes_allocated += atomic_load_explicit(&slot->bytes_allocated, memory_order_relaxed);
+		for(int k = 0; k < MEMORY_TRACKING_SIZE_CLASSES; ++k)
+			stats->size_classes[k] += atomic_load_explicit(&slot->size_classes[k], memory_order_relaxed);
+		long long slot_peak = atomic_load_explicit(&slot->peak_bytes, memory_order_relaxed);
+		if(slot_peak > max_slot_peak)
+			max_slot_peak = slot_peak;
+	}
+	//exact with a single thread, a lower bound otherwise
+	stats->peak_bytes = atomic_load_explicit(&tag->peak_bytes, memory_order_relaxed);
+	if(max_slot_peak > stats->peak_bytes)
+		stats->peak_bytes = max_slot_peak;
+	stats->live_allocations = (long long)stats->allocations - (long long)stats->deallocations;
+}
+
+void memory_tracking_dump(void)
+{
+	memory_tag_default_register();
+	memory_tags_lock_acquire();
+	for(struct memory_tag *tag = memory_tags; tag; tag = tag->next)
+	{
+		struct memory_tag_stats stats;
+		memory_tag_stats(tag, &stats);
+		printf("%s: %lld bytes live in %lld allocations, peak %lld bytes, %zu allocations, %zu frees\n",
+			tag->name, stats.live_bytes, stats.live_allocations, stats.peak_bytes, stats.allocations, stats.deallocations);
+		for(int k = 0; k < MEMORY_TRACKING_SIZE_CLASSES; ++k)
+		{
+			if(stats.size_classes[k])
+				printf("\t<= %zu bytes: %zu\n", (size_t)1 << k, stats.size_classes[k]);
+		}
+	}
+	memory_tags_lock_release();
+}
+#endif
+#endif
+#endif
@@ -2,15 +2,66 @@
 #define PARSE_H
 
 #include <stdio.h> //FILE
-#include <stdlib.h> //atof
+#include <stdlib.h> //strtod, strtof
+#include <stdint.h>
+#include <float.h> //FLT_EVAL_METHOD
+#include <locale.h> //localeconv
 #include <ctype.h> //isspace
+#include <stdatomic.h> //the scanner table picked at runtime
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PARSE_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
 //should probably make heap_string a struct and forward declare it in the func prototype below
 #include "heap_string.h"
 
+/* in memory input, cur is advanced as things get parsed */
+struct parse_buffer
+{
+	const char *cur;
+	const char *end;
+};
+
+#define parse_buffer_eof(pb) ((pb)->cur >= (pb)->end)
+
+/* points into the parsed input, not terminated and only valid as long as the input is */
+struct parse_slice
+{
+	const char *ptr;
+	size_t len;
+};
+
+enum parse_token_type
+{
+	PARSE_TOKEN_NONE, //end of input
+	PARSE_TOKEN_IDENT, //[A-Za-z_][A-Za-z0-9_]*
+	PARSE_TOKEN_NUMBER, //anything parse_double accepts
+	PARSE_TOKEN_PUNCT, //any other single character
+	PARSE_TOKEN_NEWLINE
+};
+
+static inline int parse_is_ident_char(int c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static inline int parse_slice_equals(const struct parse_slice *slice, const char *str)
+{
+	return !strncmp(slice->ptr, str, slice->len) && str[slice->len] == '\0';
+}
+
 #ifndef PARSE_IMPL
 void parse_whitespace(FILE *fp);
 void parse_skip_line(FILE *fp);
 int parse_float(FILE *fp, float* out);
+int parse_double(FILE *fp, double *out);
+/* returns the number of characters consumed, 0 if buf doesn't start with a number */
+size_t parse_float_from_buffer(const char *buf, size_t n, float *out);
+size_t parse_double_from_buffer(const char *buf, size_t n, double *out);
 int parse_float3(FILE *fp, float *v);
 /* don't forget to free ident! */
 int parse_ident(FILE *fp, heap_string *ident);
@@ -18,6 +69,29 @@ int parse_character(FILE *fp, int ch);
 int parse_characters(FILE *fp, const char *str);
 int parse_ident_to_buffer(FILE *fp, char *buf, size_t bufsz, int *overflow);
 int fpeekc(FILE *fp);
+
+/* same as the FILE* versions, except running into the end of the buffer right after a value isn't an error */
+void parse_buffer_init(struct parse_buffer *pb, const char *buf, size_t n);
+void parse_buffer_whitespace(struct parse_buffer *pb);
+void parse_buffer_skip_line(struct parse_buffer *pb);
+int parse_buffer_float(struct parse_buffer *pb, float *out);
+int parse_buffer_double(struct parse_buffer *pb, double *out);
+int parse_buffer_float3(struct parse_buffer *pb, float *v);
+int parse_buffer_ident_to_buffer(struct parse_buffer *pb, char *buf, size_t bufsz, int *overflow);
+/* zero copy, ident points into the buffer. returns 1 if there's nothing left */
+int parse_buffer_ident(struct parse_buffer *pb, struct parse_slice *ident);
+/* skips blanks (not newlines), returns the enum parse_token_type of the token */
+int parse_buffer_token(struct parse_buffer *pb, struct parse_slice *token);
+int parse_buffer_character(struct parse_buffer *pb, int ch);
+int parse_buffer_characters(struct parse_buffer *pb, const char *str);
+
+/* vectorized (SSE2/AVX2, picked at runtime) scanners, each returns end if nothing was found */
+//first character that isn't ' ' or '\t'
+const char *parse_scan_blank(const char *p, const char *end);
+//first '\n'
+const char *parse_scan_newline(const char *p, const char *end);
+//first isspace character, i.e the end of what parse_ident reads
+const char *parse_scan_ident_end(const char *p, const char *end);
 #else
 int fpeekc(FILE *fp)
 {
@@ -28,40 +102,509 @@ int fpeekc(FILE *fp)
 
 void parse_whitespace(FILE *fp)
 {
-	while(1)
+	int c;
+	do
 	{
-		int pk = fpeekc(fp);
-		if(pk == EOF)
+		c = getc(fp);
+	} while(c == ' ' || c == '\t');
+	if(c != EOF)
+		ungetc(c, fp);
+}
+
+void parse_skip_line(FILE *fp)
+{
+	//let stdio look for the newline a buffer at a time
+	char buf[256];
+	for(;;)
+	{
+		buf[sizeof(buf) - 2] = '\0';
+		if(!fgets(buf, sizeof(buf), fp))
 			return;
-		if(pk != ' ' && pk != '\t')
+		//only a full buffer without a newline at the end means the line continues
+		if(buf[sizeof(buf) - 2] == '\0' || buf[sizeof(buf) - 2] == '\n')
 			return;
-		fgetc(fp);
 	}
 }
 
-void parse_skip_line(FILE *fp)
+static const char *parse_scan_blank_scalar(const char *p, const char *end)
 {
-	int c;
-	do
+	while(p < end && (*p == ' ' || *p == '\t'))
+		++p;
+	return p;
+}
+
+static const char *parse_scan_newline_scalar(const char *p, const char *end)
+{
+	const char *nl = memchr(p, '\n', end - p);
+	return nl ? nl : end;
+}
+
+static const char *parse_scan_ident_end_scalar(const char *p, const char *end)
+{
+	while(p < end && !isspace((unsigned char)*p))
+		++p;
+	return p;
+}
+
+#ifdef PARSE_SIMD_X86
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define PARSE_TARGET_SSE2
+#define PARSE_TARGET_AVX2
+static inline int parse_ctz(unsigned int v)
+{
+	unsigned long index;
+	_BitScanForward(&index, v);
+	return (int)index;
+}
+#else
+#define PARSE_TARGET_SSE2 __attribute__((target("sse2")))
+#define PARSE_TARGET_AVX2 __attribute__((target("avx2")))
+#define parse_ctz(v) __builtin_ctz(v)
+#endif
+
+//whitespace as in isspace, ' ' or 9 ('\t') through 13 ('\r')
+PARSE_TARGET_SSE2 static inline __m128i parse_isspace_sse2(__m128i v)
+{
+	__m128i x = _mm_sub_epi8(v, _mm_set1_epi8(9));
+	__m128i ctrl = _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8(4)), x);
+	return _mm_or_si128(ctrl, _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+}
+
+PARSE_TARGET_SSE2 static const char *parse_scan_blank_sse2(const char *p, const char *end)
+{
+	for(; end - p >= 16; p += 16)
 	{
-		c = fgetc(fp);
-	} while(c != EOF && c != '\n');
+		__m128i v = _mm_loadu_si128((const __m128i*)p);
+		__m128i blank = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+		unsigned int mask = ~_mm_movemask_epi8(blank) & 0xFFFF;
+		if(mask)
+			return p + parse_ctz(mask);
+	}
+	return parse_scan_blank_scalar(p, end);
 }
 
-int parse_float(FILE *fp, float* out)
+PARSE_TARGET_SSE2 static const char *parse_scan_newline_sse2(const char *p, const char *end)
+{
+	for(; end - p >= 16; p += 16)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)p);
+		unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+		if(mask)
+			return p + parse_ctz(mask);
+	}
+	return parse_scan_newline_scalar(p, end);
+}
+
+PARSE_TARGET_SSE2 static const char *parse_scan_ident_end_sse2(const char *p, const char *end)
+{
+	for(; end - p >= 16; p += 16)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)p);
+		unsigned int mask = _mm_movemask_epi8(parse_isspace_sse2(v));
+		if(mask)
+			return p + parse_ctz(mask);
+	}
+	return parse_scan_ident_end_scalar(p, end);
+}
+
+PARSE_TARGET_AVX2 static inline __m256i parse_isspace_avx2(__m256i v)
+{
+	__m256i x = _mm256_sub_epi8(v, _mm256_set1_epi8(9));
+	__m256i ctrl = _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8(4)), x);
+	return _mm256_or_si256(ctrl, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')));
+}
+
+PARSE_TARGET_AVX2 static const char *parse_scan_blank_avx2(const char *p, const char *end)
+{
+	for(; end - p >= 32; p += 32)
+	{
+		__m256i v = _mm256_loadu_si256((const __m256i*)p);
+		__m256i blank = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')));
+		unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(blank);
+		if(mask)
+			return p + parse_ctz(mask);
+	}
+	return parse_scan_blank_sse2(p, end);
+}
+
+PARSE_TARGET_AVX2 static const char *parse_scan_newline_avx2(const char *p, const char *end)
+{
+	for(; end - p >= 32; p += 32)
+	{
+		__m256i v = _mm256_loadu_si256((const __m256i*)p);
+		unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+		if(mask)
+			return p + parse_ctz(mask);
+	}
+	return parse_scan_newline_sse2(p, end);
+}
+
+PARSE_TARGET_AVX2 static const char *parse_scan_ident_end_avx2(const char *p, const char *end)
+{
+	for(; end - p >= 32; p += 32)
+	{
+		__m256i v = _mm256_loadu_si256((const __m256i*)p);
+		unsigned int mask = (unsigned int)_mm256_movemask_epi8(parse_isspace_avx2(v));
+		if(mask)
+			return p + parse_ctz(mask);
+	}
+	return parse_scan_ident_end_sse2(p, end);
+}
+
+//0 scalar, 1 SSE2, 2 AVX2
+static int parse_simd_level(void)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	if(info[0] < 7)
+		return 1;
+	__cpuid(info, 1);
+	//AVX2 needs the OS to save the ymm registers (OSXSAVE + XCR0)
+	if(!(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6)
+		return 1;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) ? 2 : 1;
+#else
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2"))
+		return 2;
+	return __builtin_cpu_supports("sse2") ? 1 : 0;
+#endif
+}
+#endif
+
+typedef const char *(*parse_scan_fn_t)(const char *p, const char *end);
+
+struct parse_scanners
+{
+	parse_scan_fn_t blank;
+	parse_scan_fn_t newline;
+	parse_scan_fn_t ident_end;
+};
+
+static const struct parse_scanners *parse_get_scanners(void)
+{
+	static const struct parse_scanners scalar = { parse_scan_blank_scalar, parse_scan_newline_scalar, parse_scan_ident_end_scalar };
+#ifdef PARSE_SIMD_X86
+	static const struct parse_scanners sse2 = { parse_scan_blank_sse2, parse_scan_newline_sse2, parse_scan_ident_end_sse2 };
+	static const struct parse_scanners avx2 = { parse_scan_blank_avx2, parse_scan_newline_avx2, parse_scan_ident_end_avx2 };
+	//every thread resolves to the same table, so relaxed loads and stores are enough
+	static const struct parse_scanners *_Atomic scanners = NULL;
+	const struct parse_scanners *s = atomic_load_explicit(&scanners, memory_order_relaxed);
+	if(s)
+		return s;
+	switch(parse_simd_level())
+	{
+		case 2: s = &avx2; break;
+		case 1: s = &sse2; break;
+		default: s = &scalar; break;
+	}
+	atomic_store_explicit(&scanners, s, memory_order_relaxed);
+	return s;
+#else
+	return &scalar;
+#endif
+}
+
+const char *parse_scan_blank(const char *p, const char *end)
+{
+	return parse_get_scanners()->blank(p, end);
+}
+
+const char *parse_scan_newline(const char *p, const char *end)
+{
+	return parse_get_scanners()->newline(p, end);
+}
+
+const char *parse_scan_ident_end(const char *p, const char *end)
+{
+	return parse_get_scanners()->ident_end(p, end);
+}
+
+//decimal number split into its parts, value = mantissa * 10^exponent
+struct parse_decimal
+{
+	uint64_t mantissa;
+	int64_t exponent;
+	int negative;
+	int too_many_digits; //mantissa didn't fit in 19 digits, needs the slow path
+	size_t length;
+};
+
+static inline int parse_is_eight_digits(uint64_t v)
+{
+	return !(((v + 0x4646464646464646ULL) | (v - 0x3030303030303030ULL)) & 0x8080808080808080ULL);
+}
+
+//SWAR, converts 8 ascii digits (little endian load) at once
+static inline uint32_t parse_eight_digits(uint64_t v)
+{
+	const uint64_t mask = 0x000000FF000000FFULL;
+	const uint64_t mul1 = 0x000F424000000064ULL; //100 + (1000000ULL << 32)
+	const uint64_t mul2 = 0x0000271000000001ULL; //1 + (10000ULL << 32)
+	v -= 0x3030303030303030ULL;
+	v = (v * 10) + (v >> 8);
+	v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+	return (uint32_t)v;
+}
+
+static inline uint64_t parse_read_u64(const char *p)
+{
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	v = __builtin_bswap64(v);
+#endif
+	return v;
+}
+
+static const char *parse_digits(const char *p, const char *end, uint64_t *mantissa)
+{
+	uint64_t m = *mantissa;
+	while(end - p >= 8 && parse_is_eight_digits(parse_read_u64(p)))
+	{
+		m = m * 100000000 + parse_eight_digits(parse_read_u64(p));
+		p += 8;
+	}
+	while(p < end && (unsigned)(*p - '0') < 10)
+	{
+		m = m * 10 + (uint64_t)(*p - '0');
+		++p;
+	}
+	*mantissa = m;
+	return p;
+}
+
+//[+-]?digits*(.digits*)?([eE][+-]?digits+)? with at least one digit in the mantissa
+static int parse_decimal_scan(const char *buf, size_t n, struct parse_decimal *d)
+{
+	const char *p = buf;
+	const char *end = buf + n;
+	
+	d->mantissa = 0;
+	d->exponent = 0;
+	d->negative = 0;
+	d->too_many_digits = 0;
+	d->length = 0;
+	
+	if(p < end && (*p == '-' || *p == '+'))
+	{
+		d->negative = *p == '-';
+		++p;
+	}
+	const char *int_start = p;
+	p = parse_digits(p, end, &d->mantissa);
+	size_t num_digits = p - int_start;
+	
+	if(p < end && *p == '.')
+	{
+		++p;
+		const char *frac_start = p;
+		p = parse_digits(p, end, &d->mantissa);
+		d->exponent = -(int64_t)(p - frac_start);
+		num_digits += p - frac_start;
+	}
+	if(num_digits == 0)
+		return 1;
+	
+	if(p < end && (*p == 'e' || *p == 'E'))
+	{
+		const char *e = p + 1;
+		int negative_exponent = 0;
+		if(e < end && (*e == '-' || *e == '+'))
+		{
+			negative_exponent = *e == '-';
+			++e;
+		}
+		//no digits after the 'e' means it isn't part of the number
+		if(e < end && (unsigned)(*e - '0') < 10)
+		{
+			int64_t exp_number = 0;
+			while(e < end && (unsigned)(*e - '0') < 10)
+			{
+				if(exp_number < 0x10000)
+					exp_number = exp_number * 10 + (*e - '0');
+				++e;
+			}
+			d->exponent += negative_exponent ? -exp_number : exp_number;
+			p = e;
+		}
+	}
+	d->length = p - buf;
+	
+	if(num_digits > 19)
+	{
+		//leading zeros don't count towards the mantissa
+		const char *s = int_start;
+		while(s < p && (*s == '0' || *s == '.'))
+			++s;
+		size_t significant = 0;
+		for(; s < p && *s != 'e' && *s != 'E'; ++s)
+			if(*s != '.')
+				++significant;
+		d->too_many_digits = significant > 19;
+	}
+	return 0;
+}
+
+//hard cases, strtod wants the locale's decimal point and a terminated string
+static double parse_decimal_slow(const char *buf, size_t n, int single_precision)
+{
+	const char *dp = localeconv()->decimal_point;
+	size_t dplen = strlen(dp);
+	char local[128];
+	char *tmp = local;
+	if(n * dplen + 1 > sizeof(local))
+		tmp = malloc(n * dplen + 1);
+	size_t k = 0;
+	for(size_t i = 0; i < n; ++i)
+	{
+		if(buf[i] == '.')
+		{
+			memcpy(&tmp[k], dp, dplen);
+			k += dplen;
+		} else
+			tmp[k++] = buf[i];
+	}
+	tmp[k] = '\0';
+	double value = single_precision ? strtof(tmp, NULL) : strtod(tmp, NULL);
+	if(tmp != local)
+		free(tmp);
+	return value;
+}
+
+//Clinger's fast path, both operands are exact so the result is correctly rounded
+static int parse_decimal_to_double_fast(const struct parse_decimal *d, double *out)
+{
+	//exactly representable powers of ten
+	static const double powers[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+#if FLT_EVAL_METHOD == 0
+	if(d->too_many_digits || d->mantissa > (1ULL << 53) || d->exponent < -22 || d->exponent > 22 + 15)
+		return 1;
+	uint64_t m = d->mantissa;
+	int64_t e = d->exponent;
+	//1.5e30 -> 15000000e23, as long as the mantissa stays exact
+	while(e > 22 && m <= (1ULL << 53) / 10)
+	{
+		m *= 10;
+		--e;
+	}
+	if(e > 22)
+		return 1;
+	double value = (double)m;
+	value = e < 0 ? value / powers[-e] : value * powers[e];
+	*out = d->negative ? -value : value;
+	return 0;
+#else
+	(void)d;
+	(void)out;
+	(void)powers;
+	return 1;
+#endif
+}
+
+size_t parse_double_from_buffer(const char *buf, size_t n, double *out)
+{
+	struct parse_decimal d;
+	if(parse_decimal_scan(buf, n, &d))
+		return 0;
+	
+	if(d.mantissa == 0 && !d.too_many_digits)
+	{
+		*out = d.negative ? -0.0 : 0.0;
+		return d.length;
+	}
+	if(parse_decimal_to_double_fast(&d, out))
+		*out = parse_decimal_slow(buf, d.length, 0);
+	return d.length;
+}
+
+size_t parse_float_from_buffer(const char *buf, size_t n, float *out)
+{
+	static const float powers[] = {
+		1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+	};
+	struct parse_decimal d;
+	if(parse_decimal_scan(buf, n, &d))
+		return 0;
+	
+	if(d.mantissa == 0 && !d.too_many_digits)
+	{
+		*out = d.negative ? -0.0f : 0.0f;
+		return d.length;
+	}
+#if FLT_EVAL_METHOD == 0
+	if(!d.too_many_digits && d.mantissa <= (1ULL << 24) && d.exponent >= -10 && d.exponent <= 10)
+	{
+		float value = (float)d.mantissa;
+		value = d.exponent < 0 ? value / powers[-d.exponent] : value * powers[d.exponent];
+		*out = d.negative ? -value : value;
+		return d.length;
+	}
+#endif
+	//rounding the correctly rounded double again is only wrong when it lands exactly between two floats
+	double value;
+	if(!parse_decimal_to_double_fast(&d, &value))
+	{
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		if((value >= FLT_MIN || value <= -FLT_MIN) && (bits & 0x1FFFFFFFULL) != 0x10000000ULL)
+		{
+			*out = (float)value;
+			return d.length;
+		}
+	}
+	*out = (float)parse_decimal_slow(buf, d.length, 1);
+	return d.length;
+}
+
+//reads the characters that can make up a number, returns the terminating character
+static int parse_number_to_buffer(FILE *fp, char *buf, size_t bufsz, size_t *n)
 {
 	int c;
-	char string[128]; //let's just allow up to 128..
-	size_t stringindex = 0;
-	do
+	size_t index = 0;
+	for(;;)
 	{
-		if(stringindex >= sizeof(string))
-			return 1;
 		c = fgetc(fp);
-		string[stringindex++ % sizeof(string)] = c;
-	} while(c != EOF && ( c == 'e' || isdigit(c) || c == '-' || c == '.' ));
-	*out = (float)atof(string);
+		if(c == EOF || !(isdigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E'))
+			break;
+		if(index + 1 >= bufsz)
+			break;
+		buf[index++] = c;
+	}
 	ungetc(c, fp); //we've parsed 1 too many
+	buf[index] = '\0';
+	*n = index;
+	return c;
+}
+
+int parse_double(FILE *fp, double *out)
+{
+	char string[128]; //let's just allow up to 128..
+	size_t n;
+	int c = parse_number_to_buffer(fp, string, sizeof(string), &n);
+	if(n + 1 >= sizeof(string))
+		return 1;
+	//the whole run has to be a number, e.g 1-2.e is rejected
+	if(parse_double_from_buffer(string, n, out) != n || n == 0)
+		return 1;
+	return c == EOF ? 1 : 0;
+}
+
+int parse_float(FILE *fp, float* out)
+{
+	char string[128]; //let's just allow up to 128..
+	size_t n;
+	int c = parse_number_to_buffer(fp, string, sizeof(string), &n);
+	if(n + 1 >= sizeof(string))
+		return 1;
+	if(parse_float_from_buffer(string, n, out) != n || n == 0)
+		return 1;
 	return c == EOF ? 1 : 0;
 }
 
@@ -168,5 +711,160 @@ int parse_characters(FILE *fp, const char *str)
 	}
 	return 0;
 }
+
+void parse_buffer_init(struct parse_buffer *pb, const char *buf, size_t n)
+{
+	pb->cur = buf;
+	pb->end = buf + n;
+}
+
+void parse_buffer_whitespace(struct parse_buffer *pb)
+{
+	//most of the time there's a single space, don't bother with the scanner for that
+	if(pb->cur < pb->end && (*pb->cur == ' ' || *pb->cur == '\t'))
+		++pb->cur;
+	if(pb->cur < pb->end && (*pb->cur == ' ' || *pb->cur == '\t'))
+		pb->cur = parse_scan_blank(pb->cur, pb->end);
+}
+
+void parse_buffer_skip_line(struct parse_buffer *pb)
+{
+	const char *nl = parse_scan_newline(pb->cur, pb->end);
+	pb->cur = nl < pb->end ? nl + 1 : pb->end;
+}
+
+int parse_buffer_double(struct parse_buffer *pb, double *out)
+{
+	size_t n = parse_double_from_buffer(pb->cur, pb->end - pb->cur, out);
+	if(!n)
+		return 1;
+	pb->cur += n;
+	return 0;
+}
+
+int parse_buffer_float(struct parse_buffer *pb, float *out)
+{
+	size_t n = parse_float_from_buffer(pb->cur, pb->end - pb->cur, out);
+	if(!n)
+		return 1;
+	pb->cur += n;
+	return 0;
+}
+
+int parse_buffer_float3(struct parse_buffer *pb, float *v)
+{
+	for(int i = 0; i < 3; ++i)
+	{
+		parse_buffer_whitespace(pb);
+		if(parse_buffer_float(pb, &v[i]))
+			return 1;
+	}
+	parse_buffer_whitespace(pb);
+	return 0;
+}
+
+int parse_buffer_ident_to_buffer(struct parse_buffer *pb, char *buf, size_t bufsz, int *overflow)
+{
+	if(overflow)
+	*overflow = 0;
+	parse_buffer_whitespace(pb);
+	if(parse_buffer_eof(pb))
+	{
+		if(bufsz)
+			buf[0] = '\0';
+		return 1;
+	}
+	const char *ident_end = parse_scan_ident_end(pb->cur, pb->end);
+	size_t n = ident_end - pb->cur;
+	if(n + 1 > bufsz)
+	{
+		if(overflow)
+		*overflow = 1;
+		n = bufsz ? bufsz - 1 : 0;
+	}
+	if(bufsz)
+	{
+		memcpy(buf, pb->cur, n);
+		buf[n] = '\0';
+	}
+	pb->cur += n;
+	return 0;
+}
+
+int parse_buffer_ident(struct parse_buffer *pb, struct parse_slice *ident)
+{
+	parse_buffer_whitespace(pb);
+	ident->ptr = pb->cur;
+	if(parse_buffer_eof(pb))
+	{
+		ident->len = 0;
+		return 1;
+	}
+	pb->cur = parse_scan_ident_end(pb->cur, pb->end);
+	ident->len = pb->cur - ident->ptr;
+	return 0;
+}
+
+int parse_buffer_token(struct parse_buffer *pb, struct parse_slice *token)
+{
+	const char *p = pb->cur;
+	const char *end = pb->end;
+	while(p < end && *p != '\n' && isspace((unsigned char)*p))
+		++p;
+	token->ptr = p;
+	token->len = 0;
+	if(p >= end)
+	{
+		pb->cur = p;
+		return PARSE_TOKEN_NONE;
+	}
+	int c = (unsigned char)*p;
+	int type = PARSE_TOKEN_PUNCT;
+	if(c == '\n')
+	{
+		type = PARSE_TOKEN_NEWLINE;
+		token->len = 1;
+	} else if(parse_is_ident_char(c) && !(c >= '0' && c <= '9'))
+	{
+		const char *s = p + 1;
+		while(s < end && parse_is_ident_char((unsigned char)*s))
+			++s;
+		type = PARSE_TOKEN_IDENT;
+		token->len = s - p;
+	} else
+	{
+		//-1, .5 and 1 are numbers, a lone - or . is punctuation
+		struct parse_decimal d;
+		if(((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.') && !parse_decimal_scan(p, end - p, &d))
+		{
+			type = PARSE_TOKEN_NUMBER;
+			token->len = d.length;
+		} else
+			token->len = 1;
+	}
+	pb->cur = p + token->len;
+	return type;
+}
+
+int parse_buffer_character(struct parse_buffer *pb, int ch)
+{
+	parse_buffer_whitespace(pb);
+	if(parse_buffer_eof(pb) || *pb->cur != ch)
+		return 1;
+	++pb->cur;
+	parse_buffer_whitespace(pb);
+	return 0;
+}
+
+int parse_buffer_characters(struct parse_buffer *pb, const char *str)
+{
+	size_t len = strlen(str);
+	for(size_t i = 0; i < len; ++i)
+	{
+		if(parse_buffer_character(pb, str[i]))
+			return 1;
+	}
+	return 0;
+}
 #endif
 #endif
\ No newline at end of file
@@ -0,0 +1,260 @@
+#ifndef PARSE_PARALLEL_H
+#define PARSE_PARALLEL_H
+
+#include "memory.h"
+#include "parse.h"
+#include "thread.h"
+
+/*
+splits a line oriented file at newline boundaries and runs the line callback on a pool of threads,
+the per chunk state is handed back in chunk (file) order once all threads are done.
+
+struct obj_chunk { ...vertices... };
+
+void *begin(void *userptr, size_t chunk_index) { return calloc(1, sizeof(struct obj_chunk)); }
+int line(void *state, struct parse_buffer *line)
+{
+	struct parse_slice ident;
+	float v[3];
+	if(parse_buffer_ident(line, &ident))
+		return 0; //empty line
+	if(parse_slice_equals(&ident, "v"))
+		return parse_buffer_float3(line, v); //add v to state
+	return 0;
+}
+void end(void *userptr, size_t chunk_index, void *state) { append state to userptr, free state }
+
+parse_parallel_file("model.obj", 0, begin, line, end, &model);
+*/
+
+//called on a worker thread before the first line of a chunk, returns the state passed to the line callback
+typedef void *(*parse_parallel_chunk_begin_fn_t)(void *userptr, size_t chunk_index);
+//line doesn't include the '\n' (or '\r\n'), return non-zero to stop parsing
+typedef int (*parse_parallel_line_fn_t)(void *chunk_state, struct parse_buffer *line);
+//called on the calling thread in chunk order, merge and free the chunk state here
+typedef void (*parse_parallel_chunk_end_fn_t)(void *userptr, size_t chunk_index, void *chunk_state);
+
+#define PARSE_PARALLEL_CHUNKS_PER_THREAD (4)
+
+#ifndef PARSE_PARALLEL_IMPL
+//num_threads <= 0 uses the number of cores, returns non-zero if a line callback failed (or the file couldn't be read)
+extern int parse_parallel_buffer(const char *buf, size_t n, int num_threads,
+	parse_parallel_chunk_begin_fn_t begin_fn,
+	parse_parallel_line_fn_t line_fn,
+	parse_parallel_chunk_end_fn_t end_fn,
+	void *userptr);
+extern int parse_parallel_file(const char *filename, int num_threads,
+	parse_parallel_chunk_begin_fn_t begin_fn,
+	parse_parallel_line_fn_t line_fn,
+	parse_parallel_chunk_end_fn_t end_fn,
+	void *userptr);
+#else
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+
+struct parse_parallel_chunk
+{
+	const char *begin;
+	const char *end;
+	void *state;
+	int started;
+};
+
+struct parse_parallel_job
+{
+	struct parse_parallel_chunk *chunks;
+	size_t num_chunks;
+	size_t next_chunk;
+	int failed;
+	thread_mutex_t mutex;
+
+	parse_parallel_chunk_begin_fn_t begin_fn;
+	parse_parallel_line_fn_t line_fn;
+	void *userptr;
+};
+
+static int parse_parallel_chunk_run(struct parse_parallel_job *job, size_t index)
+{
+	struct parse_parallel_chunk *chunk = &job->chunks[index];
+	chunk->state = job->begin_fn ? job->begin_fn(job->userptr, index) : NULL;
+
+	const char *p = chunk->begin;
+	while(p < chunk->end)
+	{
+		const char *eol = parse_scan_newline(p, chunk->end);
+		struct parse_buffer line;
+		parse_buffer_init(&line, p, (eol > p && eol[-1] == '\r') ? eol - p - 1 : eol - p);
+		if(job->line_fn(chunk->state, &line))
+			return 1;
+		p = eol < chunk->end ? eol + 1 : chunk->end;
+	}
+	return 0;
+}
+
+static void parse_parallel_worker(void *userptr)
+{
+	struct parse_parallel_job *job = userptr;
+	for(;;)
+	{
+		thread_mutex_lock(&job->mutex);
+		//stop handing out chunks once one of them failed
+		size_t index = job->failed ? job->num_chunks : job->next_chunk++;
+		if(index < job->num_chunks)
+			job->chunks[index].started = 1;
+		thread_mutex_unlock(&job->mutex);
+		if(index >= job->num_chunks)
+			break;
+
+		if(parse_parallel_chunk_run(job, index))
+		{
+			thread_mutex_lock(&job->mutex);
+			job->failed = 1;
+			thread_mutex_unlock(&job->mutex);
+		}
+	}
+}
+
+int parse_parallel_buffer(const char *buf, size_t n, int num_threads,
+	parse_parallel_chunk_begin_fn_t begin_fn,
+	parse_parallel_line_fn_t line_fn,
+	parse_parallel_chunk_end_fn_t end_fn,
+	void *userptr)
+{
+	if(num_threads <= 0)
+		num_threads = thread_hardware_concurrency();
+
+	//more chunks than threads, lines don't all cost the same
+	size_t num_chunks = num_threads == 1 ? 1 : (size_t)num_threads * PARSE_PARALLEL_CHUNKS_PER_THREAD;
+	if(num_chunks > n / 4096 + 1)
+		num_chunks = n / 4096 + 1;
+
+	struct parse_parallel_job job;
+	job.chunks = memory_allocate(sizeof(struct parse_parallel_chunk) * num_chunks);
+	job.next_chunk = 0;
+	job.failed = 0;
+	job.begin_fn = begin_fn;
+	job.line_fn = line_fn;
+	job.userptr = userptr;
+	thread_mutex_init(&job.mutex);
+
+	//split at newlines, a chunk starts right after the '\n' following its nominal offset
+	const char *end = buf + n;
+	const char *p = buf;
+	job.num_chunks = 0;
+	for(size_t i = 0; i < num_chunks && p < end; ++i)
+	{
+		const char *chunk_end = end;
+		if(i + 1 < num_chunks)
+		{
+			chunk_end = buf + n / num_chunks * (i + 1);
+			if(chunk_end < p)
+				chunk_end = p;
+			chunk_end = parse_scan_newline(chunk_end, end);
+			if(chunk_end < end)
+				++chunk_end;
+		}
+		struct parse_parallel_chunk *chunk = &job.chunks[job.num_chunks++];
+		chunk->begin = p;
+		chunk->end = chunk_end;
+		chunk->state = NULL;
+		chunk->started = 0;
+		p = chunk_end;
+	}
+
+	if((size_t)num_threads > job.num_chunks)
+		num_threads = (int)job.num_chunks;
+
+	//the calling thread is one of the workers
+	thread_t *threads = NULL;
+	int num_started = 0;
+	if(num_threads > 1)
+	{
+		threads = memory_allocate(sizeof(thread_t) * (num_threads - 1));
+		for(int i = 0; i < num_threads - 1; ++i)
+		{
+			if(thread_create(&threads[num_started], parse_parallel_worker, &job))
+				break;
+			++num_started;
+		}
+	}
+	parse_parallel_worker(&job);
+	for(int i = 0; i < num_started; ++i)
+		thread_join(threads[i]);
+	if(threads)
+		memory_deallocate(threads);
+
+	for(size_t i = 0; i < job.num_chunks; ++i)
+	{
+		if(end_fn && job.chunks[i].started)
+			end_fn(userptr, i, job.chunks[i].state);
+	}
+	thread_mutex_destroy(&job.mutex);
+	memory_deallocate(job.chunks);
+	return job.failed;
+}
+
+int parse_parallel_file(const char *filename, int num_threads,
+	parse_parallel_chunk_begin_fn_t begin_fn,
+	parse_parallel_line_fn_t line_fn,
+	parse_parallel_chunk_end_fn_t end_fn,
+	void *userptr)
+{
+	int result = 1;
+	#ifdef _WIN32
+		HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if(file == INVALID_HANDLE_VALUE)
+			return 1;
+		LARGE_INTEGER size;
+		if(!GetFileSizeEx(file, &size))
+		{
+			CloseHandle(file);
+			return 1;
+		}
+		if(size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return parse_parallel_buffer("", 0, num_threads, begin_fn, line_fn, end_fn, userptr);
+		}
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if(mapping)
+		{
+			const char *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if(data)
+			{
+				result = parse_parallel_buffer(data, (size_t)size.QuadPart, num_threads, begin_fn, line_fn, end_fn, userptr);
+				UnmapViewOfFile(data);
+			}
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+	#else
+		int fd = open(filename, O_RDONLY);
+		if(fd == -1)
+			return 1;
+		struct stat st;
+		if(fstat(fd, &st))
+		{
+			close(fd);
+			return 1;
+		}
+		if(st.st_size == 0)
+		{
+			close(fd);
+			return parse_parallel_buffer("", 0, num_threads, begin_fn, line_fn, end_fn, userptr);
+		}
+		void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if(data == MAP_FAILED)
+			return 1;
+		madvise(data, st.st_size, MADV_SEQUENTIAL);
+		result = parse_parallel_buffer(data, st.st_size, num_threads, begin_fn, line_fn, end_fn, userptr);
+		munmap(data, st.st_size);
+	#endif
+	return result;
+}
+#endif
+#endif
@@ -0,0 +1,316 @@
+#ifndef PARSE_STREAM_H
+#define PARSE_STREAM_H
+
+#include "memory.h"
+#include "parse.h"
+
+/*
+push style tokenizer for input that arrives in pieces (pipes, sockets), nothing blocks and
+only the text of the token in progress is kept around between calls.
+
+struct parse_stream ps;
+parse_stream_init(&ps);
+while((n = read(fd, buf, sizeof(buf))) > 0)
+{
+	parse_stream_feed(&ps, buf, n);
+	size_t count;
+	struct parse_token *tokens = parse_stream_tokens(&ps, &count);
+	for(size_t i = 0; i < count; ++i)
+		handle(tokens[i].type, parse_stream_token_text(&ps, &tokens[i]), tokens[i].number);
+	parse_stream_clear(&ps);
+}
+parse_stream_finish(&ps); //completes the last token, collect the tokens once more
+parse_stream_free(&ps);
+*/
+
+struct parse_token
+{
+	int type; //enum parse_token_type
+	size_t offset; //into the stream's text, see parse_stream_token_text
+	size_t length;
+	double number; //PARSE_TOKEN_NUMBER only
+};
+
+struct parse_stream
+{
+	int state;
+	int seen_dot;
+	int seen_exponent;
+
+	//completed token text (each terminated) followed by the token in progress
+	char *text;
+	size_t text_size;
+	size_t text_capacity;
+	size_t token_start;
+
+	struct parse_token *tokens;
+	size_t num_tokens;
+	size_t tokens_capacity;
+};
+
+#define parse_stream_token_text(ps, token) ((const char*)&(ps)->text[(token)->offset])
+
+#ifndef PARSE_STREAM_IMPL
+extern void parse_stream_init(struct parse_stream *ps);
+extern void parse_stream_free(struct parse_stream *ps);
+//returns the number of completed tokens waiting to be collected
+extern size_t parse_stream_feed(struct parse_stream *ps, const char *buf, size_t len);
+//end of input, completes the token in progress
+extern size_t parse_stream_finish(struct parse_stream *ps);
+extern struct parse_token *parse_stream_tokens(struct parse_stream *ps, size_t *count);
+//drops the collected tokens (and their text), the token in progress is kept
+extern void parse_stream_clear(struct parse_stream *ps);
+#else
+
+enum
+{
+	PARSE_STREAM_STATE_NONE,
+	PARSE_STREAM_STATE_IDENT,
+	PARSE_STREAM_STATE_NUMBER,
+	PARSE_STREAM_STATE_SIGN, //+ or -, a number if a digit or .digit follows
+	PARSE_STREAM_STATE_SIGN_DOT, //+. or -.
+	PARSE_STREAM_STATE_DOT //., a number if a digit follows
+};
+
+void parse_stream_init(struct parse_stream *ps)
+{
+	ps->state = PARSE_STREAM_STATE_NONE;
+	ps->seen_dot = 0;
+	ps->seen_exponent = 0;
+	ps->text = NULL;
+	ps->text_size = 0;
+	ps->text_capacity = 0;
+	ps->token_start = 0;
+	ps->tokens = NULL;
+	ps->num_tokens = 0;
+	ps->tokens_capacity = 0;
+}
+
+void parse_stream_free(struct parse_stream *ps)
+{
+	if(ps->text)
+		memory_deallocate(ps->text);
+	if(ps->tokens)
+		memory_deallocate(ps->tokens);
+	parse_stream_init(ps);
+}
+
+static void parse_stream_push_char(struct parse_stream *ps, char c)
+{
+	if(ps->text_size + 1 >= ps->text_capacity)
+	{
+		size_t capacity = ps->text_capacity ? ps->text_capacity * 2 : 256;
+		char *text = memory_allocate(capacity);
+		if(ps->text)
+		{
+			memcpy(text, ps->text, ps->text_size);
+			memory_deallocate(ps->text);
+		}
+		ps->text = text;
+		ps->text_capacity = capacity;
+	}
+	ps->text[ps->text_size++] = c;
+}
+
+static struct parse_token *parse_stream_push_token(struct parse_stream *ps, int type)
+{
+	if(ps->num_tokens >= ps->tokens_capacity)
+	{
+		size_t capacity = ps->tokens_capacity ? ps->tokens_capacity * 2 : 64;
+		struct parse_token *tokens = memory_allocate(sizeof(struct parse_token) * capacity);
+		if(ps->tokens)
+		{
+			memcpy(tokens, ps->tokens, sizeof(struct parse_token) * ps->num_tokens);
+			memory_deallocate(ps->tokens);
+		}
+		ps->tokens = tokens;
+		ps->tokens_capacity = capacity;
+	}
+	//the text since token_start becomes this token
+	parse_stream_push_char(ps, '\0');
+	struct parse_token *token = &ps->tokens[ps->num_tokens++];
+	token->type = type;
+	token->offset = ps->token_start;
+	token->length = ps->text_size - 1 - ps->token_start;
+	token->number = 0.0;
+	ps->token_start = ps->text_size;
+	ps->state = PARSE_STREAM_STATE_NONE;
+	return token;
+}
+
+static void parse_stream_single(struct parse_stream *ps, int type, char c)
+{
+	parse_stream_push_char(ps, c);
+	parse_stream_push_token(ps, type);
+}
+
+size_t parse_stream_feed(struct parse_stream *ps, const char *buf, size_t len);
+
+static void parse_stream_complete_number(struct parse_stream *ps)
+{
+	const char *start = &ps->text[ps->token_start];
+	size_t n = ps->text_size - ps->token_start;
+	double value = 0.0;
+	size_t length = parse_double_from_buffer(start, n, &value);
+
+	//1e or 1e- isn't a number on its own, give the tail back to the tokenizer
+	char tail[2];
+	size_t tail_length = n - length;
+	memcpy(tail, start + length, tail_length);
+	ps->text_size = ps->token_start + length;
+	parse_stream_push_token(ps, PARSE_TOKEN_NUMBER)->number = value;
+	if(tail_length)
+		parse_stream_feed(ps, tail, tail_length);
+}
+
+//what was pending turns out to be punctuation
+static void parse_stream_flush_punct(struct parse_stream *ps)
+{
+	size_t start = ps->token_start;
+	size_t end = ps->text_size;
+	char pending[2];
+	memcpy(pending, &ps->text[start], end - start);
+	ps->text_size = start;
+	for(size_t i = 0; i < end - start; ++i)
+		parse_stream_single(ps, PARSE_TOKEN_PUNCT, pending[i]);
+}
+
+static void parse_stream_complete(struct parse_stream *ps)
+{
+	switch(ps->state)
+	{
+		case PARSE_STREAM_STATE_IDENT:
+			parse_stream_push_token(ps, PARSE_TOKEN_IDENT);
+			break;
+		case PARSE_STREAM_STATE_NUMBER:
+			parse_stream_complete_number(ps);
+			break;
+		case PARSE_STREAM_STATE_SIGN:
+		case PARSE_STREAM_STATE_SIGN_DOT:
+		case PARSE_STREAM_STATE_DOT:
+			parse_stream_flush_punct(ps);
+			break;
+	}
+}
+
+static int parse_stream_is_digit(int c)
+{
+	return c >= '0' && c <= '9';
+}
+
+size_t parse_stream_feed(struct parse_stream *ps, const char *buf, size_t len)
+{
+	size_t i = 0;
+	while(i < len)
+	{
+		int c = (unsigned char)buf[i];
+		switch(ps->state)
+		{
+			case PARSE_STREAM_STATE_NONE:
+				if(c == '\n')
+					parse_stream_single(ps, PARSE_TOKEN_NEWLINE, c);
+				else if(isspace(c))
+				{
+				} else if(parse_is_ident_char(c) && !parse_stream_is_digit(c))
+				{
+					ps->state = PARSE_STREAM_STATE_IDENT;
+					parse_stream_push_char(ps, c);
+				} else if(parse_stream_is_digit(c))
+				{
+					ps->state = PARSE_STREAM_STATE_NUMBER;
+					ps->seen_dot = 0;
+					ps->seen_exponent = 0;
+					parse_stream_push_char(ps, c);
+				} else if(c == '-' || c == '+')
+				{
+					ps->state = PARSE_STREAM_STATE_SIGN;
+					parse_stream_push_char(ps, c);
+				} else if(c == '.')
+				{
+					ps->state = PARSE_STREAM_STATE_DOT;
+					parse_stream_push_char(ps, c);
+				} else
+					parse_stream_single(ps, PARSE_TOKEN_PUNCT, c);
+				++i;
+				break;
+
+			case PARSE_STREAM_STATE_IDENT:
+				if(!parse_is_ident_char(c))
+				{
+					parse_stream_complete(ps);
+					continue; //c starts the next token
+				}
+				parse_stream_push_char(ps, c);
+				++i;
+				break;
+
+			case PARSE_STREAM_STATE_SIGN:
+			case PARSE_STREAM_STATE_SIGN_DOT:
+			case PARSE_STREAM_STATE_DOT:
+				if(parse_stream_is_digit(c))
+				{
+					ps->seen_dot = ps->state != PARSE_STREAM_STATE_SIGN;
+					ps->seen_exponent = 0;
+					ps->state = PARSE_STREAM_STATE_NUMBER;
+				} else if(c == '.' && ps->state == PARSE_STREAM_STATE_SIGN)
+				{
+					ps->state = PARSE_STREAM_STATE_SIGN_DOT;
+				} else
+				{
+					parse_stream_complete(ps);
+					continue;
+				}
+				parse_stream_push_char(ps, c);
+				++i;
+				break;
+
+			case PARSE_STREAM_STATE_NUMBER:
+			{
+				int prev = ps->text[ps->text_size - 1];
+				int accept = parse_stream_is_digit(c)
+					|| (c == '.' && !ps->seen_dot && !ps->seen_exponent)
+					|| ((c == 'e' || c == 'E') && !ps->seen_exponent)
+					|| ((c == '-' || c == '+') && (prev == 'e' || prev == 'E'));
+				if(!accept)
+				{
+					parse_stream_complete(ps);
+					continue;
+				}
+				if(c == '.')
+					ps->seen_dot = 1;
+				else if(c == 'e' || c == 'E')
+					ps->seen_exponent = 1;
+				parse_stream_push_char(ps, c);
+				++i;
+			} break;
+		}
+	}
+	return ps->num_tokens;
+}
+
+size_t parse_stream_finish(struct parse_stream *ps)
+{
+	//completing 1e gives back an ident that still has to be completed
+	while(ps->state != PARSE_STREAM_STATE_NONE)
+		parse_stream_complete(ps);
+	return ps->num_tokens;
+}
+
+struct parse_token *parse_stream_tokens(struct parse_stream *ps, size_t *count)
+{
+	*count = ps->num_tokens;
+	return ps->tokens;
+}
+
+void parse_stream_clear(struct parse_stream *ps)
+{
+	//move the token in progress to the front
+	size_t pending = ps->text_size - ps->token_start;
+	if(pending)
+		memmove(ps->text, &ps->text[ps->token_start], pending);
+	ps->text_size = pending;
+	ps->token_start = 0;
+	ps->num_tokens = 0;
+}
+#endif
+#endif
@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 
 static
 int std_fopen_s(FILE **fp, const char *filename, const char *mode)
@@ -38,4 +39,17 @@ int std_strerror_s(char *buf, size_t sz, int errnum)
 		return 0;
 	#endif
 }
+
+//monotonic where available, for measuring durations
+static
+unsigned long long std_time_ns(void)
+{
+	struct timespec ts;
+	#ifdef _WIN32
+		timespec_get(&ts, TIME_UTC);
+	#else
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+	#endif
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
 #endif
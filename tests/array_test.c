@@ -0,0 +1,75 @@
+#define ARRAY_IMPL
+#include "../array.h"
+#include <stdio.h>
+
+struct vec3
+{
+	float x, y, z;
+};
+
+static int compare_int(const void *a, const void *b)
+{
+	int x = *(const int*)a, y = *(const int*)b;
+	return (x > y) - (x < y);
+}
+
+static void *bump_allocate(void *userptr, size_t nbytes)
+{
+	++*(int*)userptr;
+	return malloc(nbytes);
+}
+
+int main(void)
+{
+	int *a = NULL;
+	assert(array_size(a) == 0);
+	for(int i = 0; i < 100; ++i)
+		array_push(a, 99 - i);
+	assert(array_size(a) == 100 && array_capacity(a) >= 100);
+	assert(a[0] == 99 && array_last(a) == 0);
+	int popped = array_pop(a);
+	assert(popped == 0);
+	
+	array_insert(a, 0, 1000);
+	array_insert(a, array_size(a), -1);
+	assert(a[0] == 1000 && a[1] == 99 && array_last(a) == -1);
+	array_erase(a, 0);
+	array_erase_swap(a, 0); //-1 takes the place of 99
+	assert(a[0] == -1 && array_size(a) == 99);
+	
+	static const int more[] = { 500, 400, 300 };
+	array_append(a, more, 3);
+	array_sort(a, compare_int);
+	for(size_t i = 1; i < array_size(a); ++i)
+		assert(a[i - 1] <= a[i]);
+	int key = 400;
+	int *found = array_bsearch(a, &key, compare_int);
+	assert(found && *found == 400);
+	key = 50;
+	assert(a[array_lower_bound(a, &key, compare_int)] == 50);
+	key = 150;
+	assert(a[array_lower_bound(a, &key, compare_int)] == 300);
+	key = 10000;
+	assert(array_lower_bound(a, &key, compare_int) == array_size(a));
+	
+	array_erase_n(a, 0, 10);
+	assert(array_size(a) == 92 && a[0] == 10);
+	array_clear(a);
+	assert(array_size(a) == 0);
+	array_free(a);
+	assert(a == NULL);
+	
+	int allocations = 0;
+	struct vec3 *points = NULL;
+	array_init_with_custom_allocator(points, 0, &allocations, bump_allocate);
+	array_reserve(points, 4);
+	for(int i = 0; i < 1000; ++i)
+		array_push(points, ((struct vec3){ i, i * 2, i * 3 }));
+	assert(points[500].y == 1000.f);
+	printf("%zu points, capacity %zu, %d allocations\n", array_size(points), array_capacity(points), allocations);
+	assert(allocations < 12);
+	array_resize(points, 10);
+	assert(array_size(points) == 10);
+	array_free(points);
+	return 0;
+}
@@ -0,0 +1,169 @@
+#define ART_IMPL
+#include "../art.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#define NUM_KEYS (20000)
+
+static int num_released = 0;
+
+static void release(void *data)
+{
+	free(*(char**)data);
+	++num_released;
+}
+
+struct collected
+{
+	const char **keys;
+	int n;
+};
+
+static int collect(void *userptr, const char *key, void *data)
+{
+	struct collected *c = userptr;
+	assert(!strcmp(*(char**)data, key));
+	c->keys[c->n++] = key;
+	return 0;
+}
+
+static int compare_keys(const void *a, const void *b)
+{
+	return strcmp(*(const char**)a, *(const char**)b);
+}
+
+static void example_paths(void)
+{
+	struct art *t = art_create(char*);
+	art_set_on_key_removal(t, release);
+	const char *paths[] = { "assets/textures/grass.png", "assets/textures/stone.png", "assets/sounds/step.wav", "assets", "assets/textures/grass.png.meta", "config.ini" };
+	for(int i = 0; i < 6; ++i)
+	{
+		char *v = strdup(paths[i]);
+		int exists = art_insert(t, paths[i], v);
+		assert(!exists);
+	}
+	char *dup = strdup("config.ini");
+	int exists = art_insert(t, "config.ini", dup);
+	assert(exists == 1);
+	free(dup);
+	assert(t->num_entries == 6);
+	char **v = art_find(t, "assets");
+	assert(v && !strcmp(*v, "assets"));
+	assert(!art_find(t, "assets/") && !art_find(t, "asset") && !art_find(t, "assets/textures/grass.pn"));
+
+	const char *found[8];
+	struct collected c = { found, 0 };
+	art_foreach_prefix(t, "assets/textures/", collect, &c);
+	assert(c.n == 3 && !strcmp(found[0], "assets/textures/grass.png") && !strcmp(found[1], "assets/textures/grass.png.meta"));
+	c.n = 0;
+	art_foreach_range(t, "assets/s", "assets/textures/s", collect, &c);
+	assert(c.n == 3 && !strcmp(found[0], "assets/sounds/step.wav") && !strcmp(found[2], "assets/textures/grass.png.meta"));
+	c.n = 0;
+	art_foreach(t, collect, &c);
+	assert(c.n == 6 && !strcmp(found[0], "assets") && !strcmp(found[5], "config.ini"));
+
+	int removed = art_remove_key(t, "assets");
+	int removed_again = art_remove_key(t, "assets");
+	assert(removed && !removed_again);
+	assert(num_released == 1 && t->num_entries == 5);
+	art_destroy(&t);
+	assert(num_released == 6);
+}
+
+static void example_random(void)
+{
+	//random keys with shared prefixes of all lengths, every node type and long compressed prefixes
+	struct art *t = art_create(char*);
+	art_set_on_key_removal(t, release);
+	const char **keys = malloc(NUM_KEYS * sizeof(char*));
+	const char **found = malloc(NUM_KEYS * sizeof(char*));
+	int n = 0;
+	srand(1234);
+	char key[64];
+	while(n < NUM_KEYS)
+	{
+		int length = 0;
+		if(rand() % 4 == 0)
+			length += snprintf(key, sizeof(key), "a long shared prefix/");
+		int parts = 1 + rand() % 6;
+		for(int i = 0; i < parts; ++i)
+			key[length++] = i == 0 && rand() % 2 ? (char)(1 + rand() % 255) : (char)('a' + rand() % 3);
+		key[length] = 0;
+		char *v = strdup(key);
+		if(art_insert(t, key, v))
+		{
+			free(v);
+			continue;
+		}
+		keys[n++] = strdup(key);
+	}
+	assert(t->num_entries == NUM_KEYS);
+	qsort(keys, n, sizeof(char*), compare_keys);
+
+	struct collected c = { found, 0 };
+	art_foreach(t, collect, &c);
+	assert(c.n == n);
+	for(int i = 0; i < n; ++i)
+		assert(!strcmp(found[i], keys[i]));
+
+	const char *prefixes[] = { "", "a", "ab", "a long", "a long shared prefix/", "a long shared prefix/ab", "cc", "\xff", "zzz" };
+	for(int p = 0; p < 9; ++p)
+	{
+		size_t length = strlen(prefixes[p]);
+		int expected = 0;
+		for(int i = 0; i < n; ++i)
+			expected += !strncmp(keys[i], prefixes[p], length);
+		c.n = 0;
+		art_foreach_prefix(t, prefixes[p], collect, &c);
+		assert(c.n == expected);
+	}
+	for(int r = 0; r < 50; ++r)
+	{
+		const char *from = keys[rand() % n];
+		const char *to = r % 5 ? keys[rand() % n] : NULL;
+		int expected = 0;
+		for(int i = 0; i < n; ++i)
+			expected += strcmp(keys[i], from) >= 0 && (!to || strcmp(keys[i], to) < 0);
+		c.n = 0;
+		art_foreach_range(t, from, to, collect, &c);
+		assert(c.n == expected);
+		//bounds that aren't keys
+		snprintf(key, sizeof(key), "%sb", from);
+		expected = 0;
+		for(int i = 0; i < n; ++i)
+			expected += strcmp(keys[i], key) >= 0;
+		c.n = 0;
+		art_foreach_range(t, key, NULL, collect, &c);
+		assert(c.n == expected);
+	}
+
+	//removing every other key shrinks the nodes back
+	for(int i = 0; i < n; i += 2)
+	{
+		int removed = art_remove_key(t, keys[i]);
+		assert(removed);
+	}
+	for(int i = 0; i < n; ++i)
+		assert(!art_find(t, keys[i]) == !(i % 2));
+	c.n = 0;
+	art_foreach(t, collect, &c);
+	assert(c.n == n / 2);
+	for(int i = 0; i < c.n; ++i)
+		assert(!strcmp(found[i], keys[i * 2 + 1]));
+	printf("%d keys, %d left after removal\n", n, c.n);
+	art_destroy(&t);
+	for(int i = 0; i < n; ++i)
+		free((char*)keys[i]);
+	free(keys);
+	free(found);
+}
+
+int main(void)
+{
+	example_paths();
+	example_random();
+	assert(num_released == 6 + NUM_KEYS);
+	return 0;
+}
@@ -0,0 +1,1393 @@
+#define HASH_MAP_IMPL
+#define LINKED_LIST_IMPL
+#define HEAP_STRING_IMPL
+#define PARSE_IMPL
+#define HASH_MAP_POD_IMPL
+#define ARRAY_IMPL
+#define HASH_MAP_PARALLEL_IMPL
+#define HASH_MAP_RCU_IMPL
+#define LRU_CACHE_IMPL
+#define ART_IMPL
+#include "../hash_map.h"
+#include "../hash_map_pod.h"
+#include "../hash_map_parallel.h"
+#include "../hash_map_rcu.h"
+#include "../lru_cache.h"
+#include "../art.h"
+#include "../array.h"
+#include "../linked_list.h"
+#include "../heap_string.h"
+#include "../parse.h"
+#include "../std.h"
+
+struct bench_vec
+{
+	float x, y, z;
+	int id;
+};
+
+#define HASH_MAP_TEMPLATE_NAME bench_int_map
+#define HASH_MAP_TEMPLATE_TYPE int
+#include "../hash_map_template.h"
+#define HASH_MAP_TEMPLATE_NAME bench_vec_map
+#define HASH_MAP_TEMPLATE_TYPE struct bench_vec
+#include "../hash_map_template.h"
+#define LINKED_LIST_TEMPLATE_NAME bench_int_list
+#define LINKED_LIST_TEMPLATE_TYPE int
+#include "../linked_list_template.h"
+#define LINKED_LIST_TEMPLATE_NAME bench_vec_list
+#define LINKED_LIST_TEMPLATE_TYPE struct bench_vec
+#include "../linked_list_template.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+/*
+benchmarks for the containers and parse.h, see run_benchmarks.sh
+
+./bench [--max-size N] [--filter substring] [--csv file] [--json file]
+	[--baseline file] [--save-baseline file] [--threshold percent]
+
+every result is compared against the baseline (a csv written by --csv or --save-baseline),
+the exit code is 1 if anything got slower than the threshold (default 10%).
+*/
+
+#define BENCH_MAX_RESULTS (1024)
+
+struct bench_result
+{
+	char name[128];
+	double ns_per_op;
+	double ops_per_sec;
+	long peak_rss_kb;
+	double baseline_ns_per_op; //0 if there's no baseline
+};
+
+struct bench_context
+{
+	size_t max_size;
+	const char *filter;
+	struct bench_result results[BENCH_MAX_RESULTS];
+	size_t num_results;
+};
+
+static struct bench_context ctx;
+
+//peak resident set size in kB, reset_peak_rss starts a new high water mark where the OS lets us
+static void reset_peak_rss(void)
+{
+#ifdef __linux__
+	FILE *fp = fopen("/proc/self/clear_refs", "w");
+	if(fp)
+	{
+		fputs("5", fp);
+		fclose(fp);
+	}
+#endif
+}
+
+static long peak_rss_kb(void)
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS pmc;
+	if(GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+		return (long)(pmc.PeakWorkingSetSize / 1024);
+	return 0;
+#else
+#ifdef __linux__
+	FILE *fp = fopen("/proc/self/status", "r");
+	if(fp)
+	{
+		char line[256];
+		long kb = -1;
+		while(fgets(line, sizeof(line), fp))
+		{
+			if(!strncmp(line, "VmHWM:", 6))
+			{
+				kb = strtol(line + 6, NULL, 10);
+				break;
+			}
+		}
+		fclose(fp);
+		if(kb >= 0)
+			return kb;
+	}
+#endif
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+#endif
+}
+
+static int bench_enabled(const char *name)
+{
+	return !ctx.filter || strstr(name, ctx.filter);
+}
+
+static void bench_record(const char *name, size_t ops, unsigned long long ns)
+{
+	if(ctx.num_results >= BENCH_MAX_RESULTS)
+		return;
+	struct bench_result *r = &ctx.results[ctx.num_results++];
+	snprintf(r->name, sizeof(r->name), "%s", name);
+	r->ns_per_op = ops ? (double)ns / ops : 0.0;
+	r->ops_per_sec = ns ? ops / (ns / 1e9) : 0.0;
+	r->peak_rss_kb = peak_rss_kb();
+	r->baseline_ns_per_op = 0.0;
+	printf("%-48s %12.2f ns/op %14.0f ops/s %10ld kB\n", r->name, r->ns_per_op, r->ops_per_sec, r->peak_rss_kb);
+	fflush(stdout);
+}
+
+//sizes 10^2, 10^3, ... up to max
+#define bench_foreach_size(var, max, ...) \
+	do { \
+		for(size_t var = 100; var <= (max); var *= 10) \
+		{ \
+			__VA_ARGS__ \
+		} \
+	} while(0)
+
+static size_t bench_repetitions(size_t n)
+{
+	//aim for roughly a million operations per measurement
+	size_t reps = 1000000 / n;
+	return reps ? reps : 1;
+}
+
+#define BENCH_TIME_BUDGET_NS (250000000ULL)
+
+//at least one repetition, stop early once the time budget is used up (quadratic cases)
+static int bench_keep_going(size_t r, size_t reps, unsigned long long ns)
+{
+	return r == 0 || (r < reps && ns < BENCH_TIME_BUDGET_NS);
+}
+
+static uint64_t bench_rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t bench_rand(void)
+{
+	//xorshift64*
+	bench_rng_state ^= bench_rng_state >> 12;
+	bench_rng_state ^= bench_rng_state << 25;
+	bench_rng_state ^= bench_rng_state >> 27;
+	return bench_rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+//n terminated keys of key_length characters, stride key_length + 1
+static char *bench_make_keys(size_t n, size_t key_length, char prefix)
+{
+	char *keys = malloc(n * (key_length + 1));
+	for(size_t i = 0; i < n; ++i)
+	{
+		char *key = &keys[i * (key_length + 1)];
+		char digits[32];
+		int len = snprintf(digits, sizeof(digits), "%c%zu", prefix, i);
+		for(size_t k = 0; k < key_length; ++k)
+			key[k] = k < (size_t)len ? digits[k] : (char)('a' + bench_rand() % 26);
+		//keep the index digits at the end too so keys longer than the digits stay distinct
+		if(key_length > (size_t)len)
+			memcpy(&key[key_length - len], digits, len);
+		key[key_length] = '\0';
+	}
+	return keys;
+}
+
+static void bench_hash_map(void)
+{
+	static const size_t key_lengths[] = { 8, 32, 128 };
+	static const char *ops[] = { "insert", "find_hit", "find_miss", "foreach", "remove" };
+	static const char *modes[] = { "hash_map", "hash_map_dense" };
+	char names[5][128];
+
+	for(int dense = 0; dense < 2; ++dense)
+	{
+		for(size_t kl = 0; kl < sizeof(key_lengths) / sizeof(key_lengths[0]); ++kl)
+		{
+			size_t key_length = key_lengths[kl];
+			bench_foreach_size(n, ctx.max_size,
+			{
+				int enabled = 0;
+				for(int op = 0; op < 5; ++op)
+				{
+					snprintf(names[op], sizeof(names[op]), "%s/%s/k%zu/%zu", modes[dense], ops[op], key_length, n);
+					enabled |= bench_enabled(names[op]);
+				}
+				if(!enabled)
+					continue;
+				char *keys = bench_make_keys(n, key_length, 'k');
+				char *miss_keys = bench_make_keys(n, key_length, 'm');
+				size_t stride = key_length + 1;
+				size_t reps = bench_repetitions(n);
+				unsigned long long ns[5] = {0};
+				size_t found = 0, sum = 0;
+
+				reset_peak_rss();
+				size_t r;
+				for(r = 0; bench_keep_going(r, reps, ns[0] + ns[1] + ns[2] + ns[3] + ns[4]); ++r)
+				{
+					struct hash_map *hm = dense ? hash_map_create_dense(size_t) : hash_map_create(size_t);
+
+					unsigned long long start = std_time_ns();
+					for(size_t i = 0; i < n; ++i)
+						hash_map_insert(hm, &keys[i * stride], i);
+					ns[0] += std_time_ns() - start;
+
+					start = std_time_ns();
+					for(size_t i = 0; i < n; ++i)
+						found += hash_map_find(hm, &keys[i * stride]) != NULL;
+					ns[1] += std_time_ns() - start;
+
+					start = std_time_ns();
+					for(size_t i = 0; i < n; ++i)
+						found += hash_map_find(hm, &miss_keys[i * stride]) != NULL;
+					ns[2] += std_time_ns() - start;
+
+					start = std_time_ns();
+					hash_map_foreach_entry(hm, entry,
+					{
+						sum += *(size_t*)entry->data;
+					});
+					ns[3] += std_time_ns() - start;
+
+					start = std_time_ns();
+					for(size_t i = 0; i < n; ++i)
+						hash_map_remove_key(&hm, &keys[i * stride]);
+					ns[4] += std_time_ns() - start;
+
+					hash_map_destroy(&hm);
+				}
+				if(found != n * r || sum != (n * (n - 1) / 2) * r)
+					printf("%s: found %zu, expected %zu\n", modes[dense], found, n * r);
+
+				for(int op = 0; op < 5; ++op)
+				{
+					if(bench_enabled(names[op]))
+						bench_record(names[op], n * r, ns[op]);
+				}
+				free(keys);
+				free(miss_keys);
+			});
+		}
+	}
+}
+
+//loading n known entries: one at a time, after hash_map_reserve, and through hash_map_insert_batch
+static void bench_hash_map_load(void)
+{
+	static const char *ops[] = { "insert", "reserve", "batch", "batch_unique", "parallel" };
+	char names[5][128];
+
+	bench_foreach_size(n, ctx.max_size * 10,
+	{
+		int enabled = 0;
+		for(int op = 0; op < 5; ++op)
+		{
+			snprintf(names[op], sizeof(names[op]), "hash_map_load/%s/%zu", ops[op], n);
+			enabled |= bench_enabled(names[op]);
+		}
+		if(!enabled)
+			continue;
+		char *storage = bench_make_keys(n, 16, 'k');
+		const char **keys = malloc(sizeof(char*) * n);
+		size_t *values = malloc(sizeof(size_t) * n);
+		for(size_t i = 0; i < n; ++i)
+		{
+			keys[i] = &storage[i * 17];
+			values[i] = i;
+		}
+		size_t reps = bench_repetitions(n);
+
+		for(int op = 0; op < 5; ++op)
+		{
+			if(!bench_enabled(names[op]))
+				continue;
+			reset_peak_rss();
+			unsigned long long ns = 0;
+			size_t r;
+			for(r = 0; bench_keep_going(r, reps, ns); ++r)
+			{
+				if(op == 4)
+				{
+					//all cores, creating the map is part of the build
+					unsigned long long start = std_time_ns();
+					struct hash_map *hm = hash_map_build_parallel(keys, values, n, 0, 0);
+					ns += std_time_ns() - start;
+					if(hm->num_entries != n)
+						printf("hash_map_load: %zu entries, expected %zu\n", hm->num_entries, n);
+					hash_map_destroy(&hm);
+					continue;
+				}
+				struct hash_map *hm = hash_map_create(size_t);
+				unsigned long long start = std_time_ns();
+				if(op == 1)
+					hash_map_reserve(hm, n);
+				if(op < 2)
+				{
+					for(size_t i = 0; i < n; ++i)
+						hash_map_insert(hm, keys[i], values[i]);
+				} else
+					hash_map_insert_batch(hm, keys, values, n, op == 3 ? HASH_MAP_BATCH_UNIQUE : 0);
+				ns += std_time_ns() - start;
+				if(hm->num_entries != n)
+					printf("hash_map_load: %zu entries, expected %zu\n", hm->num_entries, n);
+				hash_map_destroy(&hm);
+			}
+			bench_record(names[op], n * r, ns);
+		}
+		free(values);
+		free(keys);
+		free(storage);
+	});
+}
+
+//after removing 90% of the entries: no shrinking, the default shrink threshold, and shrinking plus hash_map_compact
+static void bench_hash_map_purge(void)
+{
+	static const char *modes[] = { "kept", "shrunk", "compacted" };
+	char names[3][2][128];
+
+	bench_foreach_size(n, ctx.max_size,
+	{
+		if(n < 1000)
+			continue;
+		int enabled = 0;
+		for(int m = 0; m < 3; ++m)
+		{
+			snprintf(names[m][0], sizeof(names[m][0]), "hash_map_purge/%s/find_hit/%zu", modes[m], n);
+			snprintf(names[m][1], sizeof(names[m][1]), "hash_map_purge/%s/foreach/%zu", modes[m], n);
+			enabled |= bench_enabled(names[m][0]) | bench_enabled(names[m][1]);
+		}
+		if(!enabled)
+			continue;
+		char *keys = bench_make_keys(n, 16, 'k');
+		size_t reps = bench_repetitions(n / 10);
+
+		for(int m = 0; m < 3; ++m)
+		{
+			if(!bench_enabled(names[m][0]) && !bench_enabled(names[m][1]))
+				continue;
+			struct hash_map *hm = hash_map_create(size_t);
+			if(m == 0)
+				hash_map_set_shrink_threshold(hm, 0.0);
+			for(size_t i = 0; i < n; ++i)
+				hash_map_insert(hm, &keys[i * 17], i);
+			for(size_t i = 0; i < n; ++i)
+			{
+				if(i % 10)
+					hash_map_remove_key(&hm, &keys[i * 17]);
+			}
+			if(m == 2)
+				hash_map_compact(hm);
+
+			reset_peak_rss();
+			unsigned long long ns[2] = {0};
+			size_t found = 0, sum = 0;
+			size_t r;
+			for(r = 0; bench_keep_going(r, reps, ns[0] + ns[1]); ++r)
+			{
+				unsigned long long start = std_time_ns();
+				for(size_t i = 0; i < n; i += 10)
+					found += hash_map_find(hm, &keys[i * 17]) != NULL;
+				ns[0] += std_time_ns() - start;
+
+				start = std_time_ns();
+				hash_map_foreach_entry(hm, entry,
+				{
+					sum += *(size_t*)entry->data;
+				});
+				ns[1] += std_time_ns() - start;
+			}
+			if(found != hm->num_entries * r)
+				printf("hash_map_purge: found %zu, expected %zu\n", found, hm->num_entries * r);
+			for(int op = 0; op < 2; ++op)
+			{
+				if(bench_enabled(names[m][op]))
+					bench_record(names[m][op], hm->num_entries * r, ns[op]);
+			}
+			hash_map_destroy(&hm);
+		}
+		free(keys);
+	});
+}
+
+//reads through a snapshot (one read_begin/read_end per lookup) and single value updates that are published at once
+static void bench_hash_map_rcu(void)
+{
+	static const char *ops[] = { "find", "set_publish" };
+	char names[2][128];
+
+	bench_foreach_size(n, ctx.max_size,
+	{
+		int enabled = 0;
+		for(int op = 0; op < 2; ++op)
+		{
+			snprintf(names[op], sizeof(names[op]), "hash_map_rcu/%s/%zu", ops[op], n);
+			enabled |= bench_enabled(names[op]);
+		}
+		if(!enabled)
+			continue;
+		char *keys = bench_make_keys(n, 16, 'k');
+		size_t reps = bench_repetitions(n);
+		unsigned long long ns[2] = {0};
+		size_t found = 0;
+
+		reset_peak_rss();
+		struct hash_map_rcu *rcu = hash_map_rcu_create(size_t);
+		for(size_t i = 0; i < n; ++i)
+			hash_map_rcu_insert(rcu, &keys[i * 17], i);
+		hash_map_rcu_publish(rcu);
+		struct hash_map_rcu_reader *reader = hash_map_rcu_reader_register(rcu);
+		size_t r;
+		for(r = 0; bench_keep_going(r, reps, ns[0] + ns[1]); ++r)
+		{
+			unsigned long long start = std_time_ns();
+			for(size_t i = 0; i < n; ++i)
+			{
+				struct hash_map *snapshot = hash_map_rcu_read_begin(rcu, reader);
+				found += hash_map_find(snapshot, &keys[i * 17]) != NULL;
+				hash_map_rcu_read_end(reader);
+			}
+			ns[0] += std_time_ns() - start;
+
+			//publishing copies the bucket array, so updates are capped at a few thousand per repetition
+			size_t updates = n < 4096 ? n : 4096;
+			start = std_time_ns();
+			for(size_t i = 0; i < updates; ++i)
+			{
+				hash_map_rcu_set(rcu, &keys[i * 17], r);
+				hash_map_rcu_publish(rcu);
+			}
+			ns[1] += std_time_ns() - start;
+		}
+		if(found != n * r)
+			printf("hash_map_rcu: found %zu, expected %zu\n", found, n * r);
+		if(bench_enabled(names[0]))
+			bench_record(names[0], n * r, ns[0]);
+		if(bench_enabled(names[1]))
+			bench_record(names[1], (n < 4096 ? n : 4096) * r, ns[1]);
+		hash_map_rcu_reader_unregister(reader);
+		hash_map_rcu_destroy(&rcu);
+		free(keys);
+	});
+}
+
+//the cache everyone writes by hand: a hash_map pointing at linked_list nodes, a hit erases the node and prepends a new one
+struct bench_lru_item
+{
+	const char *key;
+	size_t value;
+};
+
+#define bench_lru_node(value_ptr) ((struct linked_list_node*)((unsigned char*)(value_ptr) - offsetof(struct linked_list_node, data)))
+
+static void bench_lru_list_put(struct hash_map *hm, struct linked_list *list, size_t capacity, const char *key, size_t value)
+{
+	if(hm->num_entries == capacity)
+	{
+		struct bench_lru_item *oldest = (struct bench_lru_item*)list->tail->data;
+		hash_map_remove_key(&hm, oldest->key);
+		linked_list_erase_node(list, list->tail);
+	}
+	struct bench_lru_item item = { key, value };
+	struct linked_list_node *node = bench_lru_node(linked_list_prepend(list, item));
+	hash_map_insert(hm, key, node);
+}
+
+static int bench_lru_list_get(struct hash_map *hm, struct linked_list *list, const char *key, size_t *value)
+{
+	struct linked_list_node **node = hash_map_find(hm, key);
+	if(!node)
+		return 0;
+	struct bench_lru_item item = *(struct bench_lru_item*)(*node)->data;
+	*value = item.value;
+	linked_list_erase_node(list, *node);
+	*node = bench_lru_node(linked_list_prepend(list, item));
+	return 1;
+}
+
+//a cache of n entries, get_hit looks up the resident keys, put_evict cycles through twice as many keys so every put evicts
+static void bench_lru(void)
+{
+	static const char *impls[] = { "lru_cache", "hash_map_list" };
+	static const char *ops[] = { "get_hit", "put_evict" };
+	char names[2][2][128];
+
+	bench_foreach_size(n, ctx.max_size,
+	{
+		int enabled = 0;
+		for(int impl = 0; impl < 2; ++impl)
+		{
+			for(int op = 0; op < 2; ++op)
+			{
+				snprintf(names[impl][op], sizeof(names[impl][op]), "lru/%s/%s/%zu", impls[impl], ops[op], n);
+				enabled |= bench_enabled(names[impl][op]);
+			}
+		}
+		if(!enabled)
+			continue;
+		char *keys = bench_make_keys(n * 2, 16, 'k');
+		size_t reps = bench_repetitions(n);
+
+		for(int impl = 0; impl < 2; ++impl)
+		{
+			if(!bench_enabled(names[impl][0]) && !bench_enabled(names[impl][1]))
+				continue;
+			reset_peak_rss();
+			unsigned long long ns[2] = {0};
+			size_t found = 0, sum = 0;
+			size_t r;
+			for(r = 0; bench_keep_going(r, reps, ns[0] + ns[1]); ++r)
+			{
+				if(impl == 0)
+				{
+					struct lru_cache *cache = lru_cache_create(size_t, n, 0);
+					for(size_t i = 0; i < n; ++i)
+						lru_cache_put(cache, &keys[i * 17], i);
+					unsigned long long start = std_time_ns();
+					for(size_t i = 0; i < n; ++i)
+					{
+						size_t *v = lru_cache_get(cache, &keys[i * 17]);
+						found += v != NULL;
+						sum += v ? *v : 0;
+					}
+					ns[0] += std_time_ns() - start;
+					start = std_time_ns();
+					for(size_t i = 0; i < n; ++i)
+						lru_cache_put(cache, &keys[(n + i) * 17], i);
+					ns[1] += std_time_ns() - start;
+					lru_cache_destroy(&cache);
+				} else
+				{
+					struct hash_map *hm = hash_map_create(struct linked_list_node*);
+					struct linked_list *list = linked_list_create(struct bench_lru_item);
+					for(size_t i = 0; i < n; ++i)
+						bench_lru_list_put(hm, list, n, &keys[i * 17], i);
+					unsigned long long start = std_time_ns();
+					for(size_t i = 0; i < n; ++i)
+					{
+						size_t v = 0;
+						found += bench_lru_list_get(hm, list, &keys[i * 17], &v);
+						sum += v;
+					}
+					ns[0] += std_time_ns() - start;
+					start = std_time_ns();
+					for(size_t i = 0; i < n; ++i)
+						bench_lru_list_put(hm, list, n, &keys[(n + i) * 17], i);
+					ns[1] += std_time_ns() - start;
+					hash_map_destroy(&hm);
+					linked_list_destroy(&list);
+				}
+			}
+			if(found != n * r || sum != n * (n - 1) / 2 * r)
+				printf("lru: found %zu, expected %zu\n", found, n * r);
+			for(int op = 0; op < 2; ++op)
+			{
+				if(bench_enabled(names[impl][op]))
+					bench_record(names[impl][op], n * r, ns[op]);
+			}
+		}
+		free(keys);
+	});
+}
+
+//lookups with and without hash_map_enable_filter, misses are keys that were never inserted
+static void bench_hash_map_filter(void)
+{
+	static const char *modes[] = { "none", "filter" };
+	static const char *ops[] = { "find_hit", "find_miss" };
+	char names[2][2][128];
+
+	bench_foreach_size(n, ctx.max_size,
+	{
+		int enabled = 0;
+		for(int m = 0; m < 2; ++m)
+		{
+			for(int op = 0; op < 2; ++op)
+			{
+				snprintf(names[m][op], sizeof(names[m][op]), "hash_map_filter/%s/%s/%zu", modes[m], ops[op], n);
+				enabled |= bench_enabled(names[m][op]);
+			}
+		}
+		if(!enabled)
+			continue;
+		char *keys = bench_make_keys(n, 16, 'k');
+		char *misses = bench_make_keys(n, 16, 'm');
+		size_t reps = bench_repetitions(n);
+
+		for(int m = 0; m < 2; ++m)
+		{
+			if(!bench_enabled(names[m][0]) && !bench_enabled(names[m][1]))
+				continue;
+			reset_peak_rss();
+			struct hash_map *hm = hash_map_create(size_t);
+			if(m == 1)
+				hash_map_enable_filter(hm, HASH_MAP_FILTER_BITS_PER_KEY);
+			for(size_t i = 0; i < n; ++i)
+				hash_map_insert(hm, &keys[i * 17], i);
+			unsigned long long ns[2] = {0};
+			size_t found = 0;
+			size_t r;
+			for(r = 0; bench_keep_going(r, reps, ns[0] + ns[1]); ++r)
+			{
+				for(int op = 0; op < 2; ++op)
+				{
+					const char *lookup = op ? misses : keys;
+					unsigned long long start = std_time_ns();
+					for(size_t i = 0; i < n; ++i)
+						found += hash_map_find(hm, &lookup[i * 17]) != NULL;
+					ns[op] += std_time_ns() - start;
+				}
+			}
+			if(found != n * r)
+				printf("hash_map_filter: found %zu, expected %zu\n", found, n * r);
+			for(int op = 0; op < 2; ++op)
+			{
+				if(bench_enabled(names[m][op]))
+					bench_record(names[m][op], n * r, ns[op]);
+			}
+			hash_map_destroy(&hm);
+		}
+		free(misses);
+		free(keys);
+	});
+}
+
+static int bench_art_count(void *userptr, const char *key, void *data)
+{
+	(void)key;
+	*(size_t*)userptr += *(size_t*)data != 0;
+	return 0;
+}
+
+//fits "assets/dir%zu/file%zu.png" for any size_t, so keys never get cut short and collide
+#define BENCH_ART_KEY_STRIDE (64)
+
+//path like keys, n / 100 directories of 100 files, point lookups and listing one directory
+static void bench_art(void)
+{
+	static const char *containers[] = { "art", "hash_map" };
+	static const char *ops[] = { "insert", "find_hit", "prefix" };
+	char names[2][3][128];
+
+	bench_foreach_size(n, ctx.max_size,
+	{
+		int enabled = 0;
+		for(int c = 0; c < 2; ++c)
+		{
+			for(int op = 0; op < 3; ++op)
+			{
+				snprintf(names[c][op], sizeof(names[c][op]), "art/%s/%s/%zu", containers[c], ops[op], n);
+				enabled |= bench_enabled(names[c][op]);
+			}
+		}
+		if(!enabled)
+			continue;
+		size_t dirs = n / 100;
+		char *keys = malloc(n * BENCH_ART_KEY_STRIDE);
+		for(size_t i = 0; i < n; ++i)
+			snprintf(&keys[i * BENCH_ART_KEY_STRIDE], BENCH_ART_KEY_STRIDE, "assets/dir%zu/file%zu.png", i % dirs, i);
+		size_t reps = bench_repetitions(n);
+
+		for(int c = 0; c < 2; ++c)
+		{
+			if(!bench_enabled(names[c][0]) && !bench_enabled(names[c][1]) && !bench_enabled(names[c][2]))
+				continue;
+			reset_peak_rss();
+			unsigned long long ns[3] = {0};
+			size_t found = 0;
+			size_t listed = 0;
+			size_t r;
+			for(r = 0; bench_keep_going(r, reps, ns[0] + ns[1] + ns[2]); ++r)
+			{
+				struct art *t = NULL;
+				struct hash_map *hm = NULL;
+				unsigned long long start = std_time_ns();
+				if(c == 0)
+				{
+					t = art_create(size_t);
+					for(size_t i = 0; i < n; ++i)
+						art_insert(t, &keys[i * BENCH_ART_KEY_STRIDE], i);
+				} else
+				{
+					hm = hash_map_create(size_t);
+					for(size_t i = 0; i < n; ++i)
+						hash_map_insert(hm, &keys[i * BENCH_ART_KEY_STRIDE], i);
+				}
+				ns[0] += std_time_ns() - start;
+
+				start = std_time_ns();
+				for(size_t i = 0; i < n; ++i)
+					found += (c == 0 ? art_find(t, &keys[i * BENCH_ART_KEY_STRIDE]) : hash_map_find(hm, &keys[i * BENCH_ART_KEY_STRIDE])) != NULL;
+				ns[1] += std_time_ns() - start;
+
+				//hash_map has no order to use, listing a directory visits every entry
+				char prefix[32];
+				snprintf(prefix, sizeof(prefix), "assets/dir%zu/", (size_t)(bench_rand() % dirs));
+				size_t prefix_length = strlen(prefix);
+				start = std_time_ns();
+				if(c == 0)
+				{
+					art_foreach_prefix(t, prefix, bench_art_count, &listed);
+				} else
+				{
+					hash_map_foreach_entry(hm, entry,
+					{
+						if(!strncmp(entry->key, prefix, prefix_length))
+							listed += *(size_t*)entry->data != 0;
+					});
+				}
+				ns[2] += std_time_ns() - start;
+				if(t)
+					art_destroy(&t);
+				if(hm)
+					hash_map_destroy(&hm);
+			}
+			if(found != n * r)
+				printf("art: found %zu, expected %zu\n", found, n * r);
+			//ops for a prefix scan are the keys it returned
+			size_t ops_done[3] = { n * r, n * r, listed ? listed : 1 };
+			for(int op = 0; op < 3; ++op)
+			{
+				if(bench_enabled(names[c][op]))
+					bench_record(names[c][op], ops_done[op], ns[op]);
+			}
+		}
+		free(keys);
+	});
+}
+
+//64 bit ids, formatted into strings for hash_map (what callers did before) and as is for hash_map_pod
+static void bench_hash_map_u64(void)
+{
+	static const char *ops[] = { "insert", "find_hit", "find_miss" };
+	char names[2][3][128];
+
+	bench_foreach_size(n, ctx.max_size,
+	{
+		int enabled = 0;
+		for(int op = 0; op < 3; ++op)
+		{
+			snprintf(names[0][op], sizeof(names[0][op]), "hash_map_u64/string/%s/%zu", ops[op], n);
+			snprintf(names[1][op], sizeof(names[1][op]), "hash_map_u64/pod/%s/%zu", ops[op], n);
+			enabled |= bench_enabled(names[0][op]) | bench_enabled(names[1][op]);
+		}
+		if(!enabled)
+			continue;
+		uint64_t *ids = malloc(sizeof(uint64_t) * n * 2); //second half misses
+		for(size_t i = 0; i < n * 2; ++i)
+			ids[i] = bench_rand();
+		size_t reps = bench_repetitions(n);
+		unsigned long long ns[2][3] = {{0}};
+		size_t found = 0;
+		char key[32];
+
+		reset_peak_rss();
+		size_t r;
+		for(r = 0; bench_keep_going(r, reps, ns[0][0] + ns[0][1] + ns[0][2] + ns[1][0] + ns[1][1] + ns[1][2]); ++r)
+		{
+			struct hash_map *hm = hash_map_create(size_t);
+			unsigned long long start = std_time_ns();
+			for(size_t i = 0; i < n; ++i)
+			{
+				snprintf(key, sizeof(key), "%llu", (unsigned long long)ids[i]);
+				hash_map_insert(hm, key, i);
+			}
+			ns[0][0] += std_time_ns() - start;
+			for(int miss = 0; miss < 2; ++miss)
+			{
+				start = std_time_ns();
+				for(size_t i = 0; i < n; ++i)
+				{
+					snprintf(key, sizeof(key), "%llu", (unsigned long long)ids[miss * n + i]);
+					found += hash_map_find(hm, key) != NULL;
+				}
+				ns[0][1 + miss] += std_time_ns() - start;
+			}
+			hash_map_destroy(&hm);
+
+			struct hash_map_pod *pm = hash_map_pod_create_u64(size_t);
+			start = std_time_ns();
+			for(size_t i = 0; i < n; ++i)
+				hash_map_u64_insert(pm, ids[i], i);
+			ns[1][0] += std_time_ns() - start;
+			for(int miss = 0; miss < 2; ++miss)
+			{
+				start = std_time_ns();
+				for(size_t i = 0; i < n; ++i)
+					found += hash_map_u64_find(pm, ids[miss * n + i]) != NULL;
+				ns[1][1 + miss] += std_time_ns() - start;
+			}
+			hash_map_pod_destroy(&pm);
+		}
+		if(found != 2 * n * r)
+			printf("hash_map_u64: found %zu, expected %zu\n", found, 2 * n * r);
+
+		for(int m = 0; m < 2; ++m)
+		{
+			for(int op = 0; op < 3; ++op)
+			{
+				if(bench_enabled(names[m][op]))
+					bench_record(names[m][op], n * r, ns[m][op]);
+			}
+		}
+		free(ids);
+	});
+}
+
+static void bench_heap_string(void)
+{
+	char name[128];
+	//push reallocates every couple of characters, quadratic so keep it at 10^5
+	size_t max_size = ctx.max_size < 100000 ? ctx.max_size : 100000;
+
+	bench_foreach_size(n, max_size,
+	{
+		size_t reps = bench_repetitions(n);
+		unsigned long long ns;
+
+		snprintf(name, sizeof(name), "heap_string/push/%zu", n);
+		if(bench_enabled(name))
+		{
+			reset_peak_rss();
+			ns = 0;
+			size_t r;
+			for(r = 0; bench_keep_going(r, reps, ns); ++r)
+			{
+				heap_string s = NULL;
+				unsigned long long start = std_time_ns();
+				for(size_t i = 0; i < n; ++i)
+					heap_string_push(&s, 'a' + i % 26);
+				ns += std_time_ns() - start;
+				heap_string_free(&s);
+			}
+			bench_record(name, n * r, ns);
+		}
+
+		//appending 16 characters at a time
+		snprintf(name, sizeof(name), "heap_string/append/%zu", n);
+		if(bench_enabled(name))
+		{
+			reset_peak_rss();
+			ns = 0;
+			size_t r;
+			for(r = 0; bench_keep_going(r, reps, ns); ++r)
+			{
+				heap_string s = NULL;
+				unsigned long long start = std_time_ns();
+				for(size_t i = 0; i < n / 16; ++i)
+					heap_string_append(&s, "0123456789abcdef");
+				ns += std_time_ns() - start;
+				heap_string_free(&s);
+			}
+			bench_record(name, n / 16 * r, ns);
+		}
+
+		snprintf(name, sizeof(name), "heap_string/appendf/%zu", n);
+		if(bench_enabled(name))
+		{
+			reset_peak_rss();
+			ns = 0;
+			size_t r;
+			for(r = 0; bench_keep_going(r, reps, ns); ++r)
+			{
+				heap_string s = NULL;
+				unsigned long long start = std_time_ns();
+				for(size_t i = 0; i < n / 16; ++i)
+					heap_string_appendf(&s, "%08zu %06.2f", i, i * 0.5);
+				ns += std_time_ns() - start;
+				heap_string_free(&s);
+			}
+			bench_record(name, n / 16 * r, ns);
+		}
+	});
+}
+
+static void bench_linked_list(void)
+{
+	char name[128];
+
+	bench_foreach_size(n, ctx.max_size,
+	{
+		size_t reps = bench_repetitions(n);
+		unsigned long long append_ns = 0, prepend_ns = 0, foreach_ns = 0, erase_ns = 0;
+		//append walks the whole list to find the end, keep it quadratic but bounded
+		int do_append = n <= 10000;
+		size_t sum = 0;
+
+		reset_peak_rss();
+		size_t r;
+		for(r = 0; bench_keep_going(r, reps, append_ns + prepend_ns + foreach_ns + erase_ns); ++r)
+		{
+			struct linked_list *list = linked_list_create(size_t);
+			unsigned long long start;
+
+			if(do_append)
+			{
+				start = std_time_ns();
+				for(size_t i = 0; i < n; ++i)
+					linked_list_append(list, i);
+				append_ns += std_time_ns() - start;
+				linked_list_destroy(&list);
+				list = linked_list_create(size_t);
+			}
+
+			start = std_time_ns();
+			for(size_t i = 0; i < n; ++i)
+				linked_list_prepend(list, i);
+			prepend_ns += std_time_ns() - start;
+
+			start = std_time_ns();
+			linked_list_foreach(list, size_t*, it,
+			{
+				sum += *it;
+			});
+			foreach_ns += std_time_ns() - start;
+
+			start = std_time_ns();
+			while(list->head)
+				linked_list_erase_node(list, list->head);
+			erase_ns += std_time_ns() - start;
+
+			linked_list_destroy(&list);
+		}
+		if(sum != (n * (n - 1) / 2) * r)
+			printf("linked_list: sum mismatch\n");
+
+		snprintf(name, sizeof(name), "linked_list/append/%zu", n);
+		if(do_append && bench_enabled(name))
+			bench_record(name, n * r, append_ns);
+		snprintf(name, sizeof(name), "linked_list/prepend/%zu", n);
+		if(bench_enabled(name))
+			bench_record(name, n * r, prepend_ns);
+		snprintf(name, sizeof(name), "linked_list/foreach/%zu", n);
+		if(bench_enabled(name))
+			bench_record(name, n * r, foreach_ns);
+		snprintf(name, sizeof(name), "linked_list/erase/%zu", n);
+		if(bench_enabled(name))
+			bench_record(name, n * r, erase_ns);
+	});
+}
+
+static struct bench_vec bench_make_vec(size_t i)
+{
+	struct bench_vec v = { (float)i, 0.5f, 2.0f, (int)i };
+	return v;
+}
+
+static int bench_make_int(size_t i)
+{
+	return (int)i;
+}
+
+static long long bench_int_value(const int *v)
+{
+	return *v;
+}
+
+static long long bench_vec_value(const struct bench_vec *v)
+{
+	return v->id;
+}
+
+//same workload as linked_list/prepend and linked_list/foreach
+static void bench_array(void)
+{
+	char name[128];
+
+	bench_foreach_size(n, ctx.max_size,
+	{
+		size_t reps = bench_repetitions(n);
+		unsigned long long push_ns = 0, foreach_ns = 0;
+		size_t sum = 0;
+
+		reset_peak_rss();
+		size_t r;
+		for(r = 0; bench_keep_going(r, reps, push_ns + foreach_ns); ++r)
+		{
+			size_t *a = NULL;
+			unsigned long long start = std_time_ns();
+			for(size_t i = 0; i < n; ++i)
+				array_push(a, i);
+			push_ns += std_time_ns() - start;
+
+			start = std_time_ns();
+			for(size_t i = 0; i < array_size(a); ++i)
+				sum += a[i];
+			foreach_ns += std_time_ns() - start;
+			array_free(a);
+		}
+		if(sum != (n * (n - 1) / 2) * r)
+			printf("array: sum mismatch\n");
+
+		snprintf(name, sizeof(name), "array/push/%zu", n);
+		if(bench_enabled(name))
+			bench_record(name, n * r, push_ns);
+		snprintf(name, sizeof(name), "array/foreach/%zu", n);
+		if(bench_enabled(name))
+			bench_record(name, n * r, foreach_ns);
+	});
+}
+
+//insert, find and prepend/foreach through the generic containers and the generated ones, same keys and payloads
+#define BENCH_TYPED(payload, type, make_value, value_of) \
+static void bench_typed_##payload(size_t n) \
+{ \
+	char name[128]; \
+	char *keys = bench_make_keys(n, 16, 'k'); \
+	size_t stride = 17; \
+	size_t reps = bench_repetitions(n); \
+	unsigned long long ns[8] = {0}; \
+	long long sum[4] = {0}; \
+	reset_peak_rss(); \
+	size_t r; \
+	for(r = 0; bench_keep_going(r, reps, ns[0] + ns[1] + ns[2] + ns[3] + ns[4] + ns[5] + ns[6] + ns[7]); ++r) \
+	{ \
+		struct hash_map *hm = hash_map_create(type); \
+		unsigned long long start = std_time_ns(); \
+		for(size_t i = 0; i < n; ++i) \
+		{ \
+			type value = make_value(i); \
+			hash_map_insert(hm, &keys[i * stride], value); \
+		} \
+		ns[0] += std_time_ns() - start; \
+		start = std_time_ns(); \
+		for(size_t i = 0; i < n; ++i) \
+			sum[0] += value_of((type*)hash_map_find(hm, &keys[i * stride])); \
+		ns[1] += std_time_ns() - start; \
+		hash_map_destroy(&hm); \
+\
+		struct bench_##payload##_map *tm = bench_##payload##_map_create(); \
+		start = std_time_ns(); \
+		for(size_t i = 0; i < n; ++i) \
+			bench_##payload##_map_insert(tm, &keys[i * stride], make_value(i)); \
+		ns[2] += std_time_ns() - start; \
+		start = std_time_ns(); \
+		for(size_t i = 0; i < n; ++i) \
+			sum[1] += value_of(bench_##payload##_map_find(tm, &keys[i * stride])); \
+		ns[3] += std_time_ns() - start; \
+		bench_##payload##_map_destroy(&tm); \
+\
+		struct linked_list *list = linked_list_create(type); \
+		start = std_time_ns(); \
+		for(size_t i = 0; i < n; ++i) \
+		{ \
+			type value = make_value(i); \
+			linked_list_prepend(list, value); \
+		} \
+		ns[4] += std_time_ns() - start; \
+		start = std_time_ns(); \
+		linked_list_foreach(list, type*, it, \
+		{ \
+			sum[2] += value_of(it); \
+		}); \
+		ns[5] += std_time_ns() - start; \
+		linked_list_destroy(&list); \
+\
+		struct bench_##payload##_list *tl = bench_##payload##_list_create(); \
+		start = std_time_ns(); \
+		for(size_t i = 0; i < n; ++i) \
+			bench_##payload##_list_prepend(tl, make_value(i)); \
+		ns[6] += std_time_ns() - start; \
+		start = std_time_ns(); \
+		linked_list_template_foreach(bench_##payload##_list, tl, node, \
+		{ \
+			sum[3] += value_of(&node->value); \
+		}); \
+		ns[7] += std_time_ns() - start; \
+		bench_##payload##_list_destroy(&tl); \
+	} \
+	if(sum[0] != sum[1] || sum[2] != sum[3] || sum[0] != sum[2]) \
+		printf("typed/" #payload ": sum mismatch\n"); \
+	static const char *names[] = { \
+		"hash_map/generic/insert", "hash_map/generic/find", "hash_map/typed/insert", "hash_map/typed/find", \
+		"linked_list/generic/prepend", "linked_list/generic/foreach", "linked_list/typed/prepend", "linked_list/typed/foreach" }; \
+	for(int op = 0; op < 8; ++op) \
+	{ \
+		snprintf(name, sizeof(name), "typed/%s/" #payload "/%zu", names[op], n); \
+		if(bench_enabled(name)) \
+			bench_record(name, n * r, ns[op]); \
+	} \
+	free(keys); \
+}
+
+BENCH_TYPED(int, int, bench_make_int, bench_int_value)
+BENCH_TYPED(vec, struct bench_vec, bench_make_vec, bench_vec_value)
+
+static void bench_typed(void)
+{
+	if(!bench_enabled("typed"))
+		return;
+	bench_foreach_size(n, ctx.max_size,
+	{
+		bench_typed_int(n);
+		bench_typed_vec(n);
+	});
+}
+
+static void bench_parse(void)
+{
+	if(!bench_enabled("parse"))
+		return;
+	size_t num_lines = ctx.max_size < 1000000 ? ctx.max_size : 1000000;
+
+	FILE *fp = tmpfile();
+	char line[128];
+	heap_string text = heap_string_alloc((int)(num_lines * 40));
+	for(size_t i = 0; i < num_lines; ++i)
+	{
+		int len = snprintf(line, sizeof(line), "v %f %f %f\n",
+			(bench_rand() % 20000) / 100.0 - 100.0, (bench_rand() % 2000) / 1000.0 - 1.0, (bench_rand() % 1000000) / 100.0);
+		fwrite(line, 1, len, fp);
+		heap_string_appendn(&text, line, len);
+	}
+	size_t text_size = heap_string_size(&text);
+	size_t reps = bench_repetitions(num_lines * 3);
+	float v[3];
+	float checksum = 0.f;
+	unsigned long long ns;
+
+	reset_peak_rss();
+	if(bench_enabled("parse/float/buffer"))
+	{
+		ns = 0;
+		size_t r;
+		for(r = 0; bench_keep_going(r, reps, ns); ++r)
+		{
+			struct parse_buffer pb;
+			parse_buffer_init(&pb, text, text_size);
+			unsigned long long start = std_time_ns();
+			while(!parse_buffer_eof(&pb))
+			{
+				struct parse_slice ident;
+				parse_buffer_ident(&pb, &ident);
+				parse_buffer_float3(&pb, v);
+				checksum += v[0];
+				parse_buffer_skip_line(&pb);
+			}
+			ns += std_time_ns() - start;
+		}
+		bench_record("parse/float/buffer", num_lines * 3 * r, ns);
+	}
+	if(bench_enabled("parse/float/file"))
+	{
+		char ident[16];
+		ns = 0;
+		size_t r;
+		for(r = 0; bench_keep_going(r, reps, ns); ++r)
+		{
+			rewind(fp);
+			unsigned long long start = std_time_ns();
+			for(size_t i = 0; i < num_lines; ++i)
+			{
+				parse_ident_to_buffer(fp, ident, sizeof(ident), NULL);
+				parse_float3(fp, v);
+				checksum += v[0];
+				parse_skip_line(fp);
+			}
+			ns += std_time_ns() - start;
+		}
+		bench_record("parse/float/file", num_lines * 3 * r, ns);
+	}
+	//every whitespace separated run is an ident
+	if(bench_enabled("parse/ident/buffer"))
+	{
+		size_t count = 0;
+		ns = 0;
+		for(size_t r = 0; bench_keep_going(r, reps, ns); ++r)
+		{
+			struct parse_buffer pb;
+			parse_buffer_init(&pb, text, text_size);
+			struct parse_slice ident;
+			unsigned long long start = std_time_ns();
+			for(;;)
+			{
+				if(parse_buffer_ident(&pb, &ident))
+					break;
+				if(!ident.len)
+					++pb.cur; //newline
+				else
+					++count;
+			}
+			ns += std_time_ns() - start;
+		}
+		bench_record("parse/ident/buffer", count, ns);
+	}
+	if(bench_enabled("parse/ident/file"))
+	{
+		char ident[64];
+		size_t count = 0;
+		ns = 0;
+		for(size_t r = 0; bench_keep_going(r, reps, ns); ++r)
+		{
+			rewind(fp);
+			unsigned long long start = std_time_ns();
+			for(;;)
+			{
+				if(parse_ident_to_buffer(fp, ident, sizeof(ident), NULL))
+					break;
+				if(!ident[0])
+					fgetc(fp); //newline
+				else
+					++count;
+			}
+			ns += std_time_ns() - start;
+		}
+		bench_record("parse/ident/file", count, ns);
+	}
+	if(checksum == 12345.f)
+		printf("unlikely\n");
+	fclose(fp);
+	heap_string_free(&text);
+}
+
+static void write_csv(const char *filename)
+{
+	FILE *fp = fopen(filename, "w");
+	if(!fp)
+	{
+		printf("can't write %s\n", filename);
+		return;
+	}
+	fprintf(fp, "name,ns_per_op,ops_per_sec,peak_rss_kb\n");
+	for(size_t i = 0; i < ctx.num_results; ++i)
+	{
+		struct bench_result *r = &ctx.results[i];
+		fprintf(fp, "%s,%.3f,%.1f,%ld\n", r->name, r->ns_per_op, r->ops_per_sec, r->peak_rss_kb);
+	}
+	fclose(fp);
+}
+
+static void write_json(const char *filename)
+{
+	FILE *fp = fopen(filename, "w");
+	if(!fp)
+	{
+		printf("can't write %s\n", filename);
+		return;
+	}
+	fprintf(fp, "[\n");
+	for(size_t i = 0; i < ctx.num_results; ++i)
+	{
+		struct bench_result *r = &ctx.results[i];
+		fprintf(fp, "\t{ \"name\": \"%s\", \"ns_per_op\": %.3f, \"ops_per_sec\": %.1f, \"peak_rss_kb\": %ld",
+			r->name, r->ns_per_op, r->ops_per_sec, r->peak_rss_kb);
+		if(r->baseline_ns_per_op > 0.0)
+			fprintf(fp, ", \"baseline_ns_per_op\": %.3f", r->baseline_ns_per_op);
+		fprintf(fp, " }%s\n", i + 1 < ctx.num_results ? "," : "");
+	}
+	fprintf(fp, "]\n");
+	fclose(fp);
+}
+
+//returns the number of regressions
+static int compare_baseline(const char *filename, double threshold)
+{
+	FILE *fp = fopen(filename, "r");
+	if(!fp)
+	{
+		printf("no baseline at %s\n", filename);
+		return 0;
+	}
+	char line[512];
+	int regressions = 0;
+	printf("\ncompared to %s (threshold %.0f%%)\n", filename, threshold);
+	while(fgets(line, sizeof(line), fp))
+	{
+		char *comma = strchr(line, ',');
+		if(!comma)
+			continue;
+		*comma = '\0';
+		double baseline = strtod(comma + 1, NULL);
+		if(baseline <= 0.0)
+			continue; //header
+		for(size_t i = 0; i < ctx.num_results; ++i)
+		{
+			struct bench_result *r = &ctx.results[i];
+			if(strcmp(r->name, line))
+				continue;
+			r->baseline_ns_per_op = baseline;
+			double change = (r->ns_per_op - baseline) / baseline * 100.0;
+			const char *verdict = "";
+			if(change > threshold)
+			{
+				verdict = "REGRESSION";
+				++regressions;
+			} else if(change < -threshold)
+				verdict = "improved";
+			printf("%-48s %12.2f -> %12.2f ns/op %+7.1f%% %s\n", r->name, baseline, r->ns_per_op, change, verdict);
+		}
+	}
+	fclose(fp);
+	printf("%d regression(s)\n", regressions);
+	return regressions;
+}
+
+int main(int argc, char **argv)
+{
+	const char *csv = NULL;
+	const char *json = NULL;
+	const char *baseline = NULL;
+	const char *save_baseline = NULL;
+	double threshold = 10.0;
+
+	ctx.max_size = 1000000;
+	for(int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+		const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+		if(!value)
+		{
+			printf("missing value for %s\n", arg);
+			return 2;
+		}
+		if(!strcmp(arg, "--max-size"))
+			ctx.max_size = strtoull(value, NULL, 10);
+		else if(!strcmp(arg, "--filter"))
+			ctx.filter = value;
+		else if(!strcmp(arg, "--csv"))
+			csv = value;
+		else if(!strcmp(arg, "--json"))
+			json = value;
+		else if(!strcmp(arg, "--baseline"))
+			baseline = value;
+		else if(!strcmp(arg, "--save-baseline"))
+			save_baseline = value;
+		else if(!strcmp(arg, "--threshold"))
+			threshold = strtod(value, NULL);
+		else
+		{
+			printf("unknown option %s\n", arg);
+			return 2;
+		}
+		++i;
+	}
+
+	bench_hash_map();
+	bench_hash_map_load();
+	bench_hash_map_purge();
+	bench_hash_map_rcu();
+	bench_lru();
+	bench_hash_map_filter();
+	bench_art();
+	bench_hash_map_u64();
+	bench_heap_string();
+	bench_linked_list();
+	bench_array();
+	bench_typed();
+	bench_parse();
+
+	int regressions = baseline ? compare_baseline(baseline, threshold) : 0;
+	if(csv)
+		write_csv(csv);
+	if(json)
+		write_json(json);
+	if(save_baseline)
+		write_csv(save_baseline);
+	return regressions ? 1 : 0;
+}
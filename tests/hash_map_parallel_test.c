@@ -0,0 +1,60 @@
+#define HASH_MAP_IMPL
+#define HASH_MAP_PARALLEL_IMPL
+#include "../hash_map_parallel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+int main(void)
+{
+	enum { N = 200000 };
+	char *storage = malloc((size_t)N * 16);
+	const char **keys = malloc(sizeof(char*) * N);
+	int *values = malloc(sizeof(int) * N);
+	//every 10th key repeats an earlier one, the first occurrence wins
+	for(int i = 0; i < N; ++i)
+	{
+		snprintf(&storage[i * 16], 16, "key%d", i % 10 == 9 ? i / 2 : i);
+		keys[i] = &storage[i * 16];
+		values[i] = i;
+	}
+
+	struct hash_map *expected = hash_map_create(int);
+	hash_map_insert_batch(expected, keys, values, N, 0);
+
+	int thread_counts[] = { 1, 3, 8 };
+	for(int t = 0; t < 3; ++t)
+	{
+		struct hash_map *hm = hash_map_build_parallel(keys, values, N, 0, thread_counts[t]);
+		assert(hm->num_entries == expected->num_entries);
+		assert(hm->bucket_size == expected->bucket_size);
+		hash_map_foreach_entry(expected, entry,
+		{
+			int *v = hash_map_find(hm, entry->key);
+			assert(v && *v == *(int*)entry->data);
+		});
+		printf("%d threads: %zu entries, %zu buckets\n", thread_counts[t], hm->num_entries, hm->bucket_size);
+
+		//it's a normal hash_map
+		int v = -1;
+		int exists = hash_map_insert(hm, "extra", v);
+		int removed = hash_map_remove_key(&hm, "key0");
+		assert(!exists && removed);
+		assert(!hash_map_find(hm, "key0"));
+		hash_map_destroy(&hm);
+	}
+
+	//distinct keys, no duplicate check
+	for(int i = 9; i < N; i += 10)
+		snprintf(&storage[i * 16], 16, "dup%d", i);
+	struct hash_map *hm = hash_map_build_parallel(keys, values, N, HASH_MAP_BATCH_UNIQUE, 4);
+	assert(hm->num_entries == N);
+	assert(*(int*)hash_map_find(hm, "dup19") == 19);
+	hash_map_destroy(&hm);
+
+	hash_map_destroy(&expected);
+	free(values);
+	free(keys);
+	free(storage);
+	return 0;
+}
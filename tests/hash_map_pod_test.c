@@ -0,0 +1,97 @@
+#define HASH_MAP_POD_IMPL
+#include "../hash_map_pod.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+struct cell
+{
+	int32_t x, y;
+	int16_t z; //padded, zero the key before filling it in
+};
+
+static void example_u64(void)
+{
+	struct hash_map_pod *hm = hash_map_pod_create_u64(double);
+	for(uint64_t i = 0; i < 10000; ++i)
+	{
+		double v = i * 0.5;
+		int exists = hash_map_u64_insert(hm, i * 0x9E3779B97F4A7C15ULL, v);
+		assert(!exists);
+	}
+	double dup = 0.0;
+	int exists = hash_map_u64_insert(hm, 0, dup);
+	assert(exists == 1);
+	assert(hm->num_entries == 10000);
+	
+	double *v = hash_map_u64_find(hm, 1234 * 0x9E3779B97F4A7C15ULL);
+	assert(v && *v == 617.0);
+	assert(!hash_map_u64_find(hm, 1234));
+	
+	for(uint64_t i = 0; i < 10000; i += 2)
+	{
+		int removed = hash_map_u64_remove_key(hm, i * 0x9E3779B97F4A7C15ULL);
+		assert(removed);
+	}
+	int removed = hash_map_u64_remove_key(hm, 0);
+	assert(!removed);
+	
+	size_t count = 0;
+	hash_map_pod_foreach_entry(hm, entry,
+	{
+		uint64_t *key = hash_map_pod_entry_key(entry);
+		double *value = hash_map_pod_entry_value(hm, entry);
+		//the odd keys are left, each with its own value
+		uint64_t i = (uint64_t)(*value * 2);
+		assert(*key == i * 0x9E3779B97F4A7C15ULL && (i & 1) == 1);
+		++count;
+	});
+	assert(count == 5000);
+	printf("%zu entries in %zu buckets after %zu rehashes\n", hm->num_entries, hm->bucket_size, hm->num_rehashes);
+	hash_map_pod_destroy(&hm);
+}
+
+static void free_name(void *p)
+{
+	free(*(char**)p);
+}
+
+static void example_struct(void)
+{
+	struct hash_map_pod *hm = hash_map_pod_create(struct cell, char*);
+	hash_map_pod_set_on_key_removal(hm, free_name);
+	
+	struct cell key;
+	memset(&key, 0, sizeof(key));
+	for(int32_t x = 0; x < 20; ++x)
+	{
+		for(int32_t y = 0; y < 20; ++y)
+		{
+			key.x = x;
+			key.y = y;
+			key.z = (int16_t)(x - y);
+			char *name = malloc(32);
+			snprintf(name, 32, "%d,%d", x, y);
+			int exists = hash_map_pod_insert(hm, key, name);
+			assert(!exists);
+		}
+	}
+	key.x = 3;
+	key.y = 4;
+	key.z = -1;
+	char **name = hash_map_pod_find(hm, &key);
+	assert(name && !strcmp(*name, "3,4"));
+	key.z = 0;
+	assert(!hash_map_pod_find(hm, &key));
+	key.z = -1;
+	int removed = hash_map_pod_remove_key(hm, &key);
+	assert(removed);
+	assert(hm->num_entries == 399);
+	hash_map_pod_destroy(&hm);
+}
+
+int main(void)
+{
+	example_u64();
+	example_struct();
+	return 0;
+}
@@ -0,0 +1,135 @@
+#define HASH_MAP_IMPL
+#define HASH_MAP_RCU_IMPL
+#define ARRAY_IMPL
+#include "../hash_map_rcu.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#define NUM_KEYS (256)
+#define NUM_READERS (3)
+
+struct setting
+{
+	int id;
+	int version;
+	int magic; //cleared by the finalizer, a reader seeing 0 saw a freed value
+};
+
+static atomic_int finalized = 0;
+static atomic_int stop = 0;
+
+static void setting_free(void *data)
+{
+	struct setting *s = *(struct setting**)data;
+	s->magic = 0;
+	free(s);
+	atomic_fetch_add(&finalized, 1);
+}
+
+static struct setting *setting_new(int id, int version)
+{
+	struct setting *s = malloc(sizeof(struct setting));
+	s->id = id;
+	s->version = version;
+	s->magic = 0x5e771;
+	return s;
+}
+
+static void reader_thread(void *userptr)
+{
+	struct hash_map_rcu *rcu = userptr;
+	struct hash_map_rcu_reader *reader = hash_map_rcu_reader_register(rcu);
+	assert(reader);
+	char key[32];
+	while(!atomic_load(&stop))
+	{
+		struct hash_map *snapshot = hash_map_rcu_read_begin(rcu, reader);
+		//a snapshot doesn't change while it's being read
+		for(int i = 0; i < NUM_KEYS; i += 7)
+		{
+			snprintf(key, sizeof(key), "setting%d", i);
+			struct setting **s = hash_map_find(snapshot, key);
+			if(s)
+			{
+				assert((*s)->magic == 0x5e771 && (*s)->id == i);
+				struct setting **again = hash_map_find(snapshot, key);
+				assert(again && *again == *s);
+			}
+		}
+		hash_map_rcu_read_end(reader);
+	}
+	hash_map_rcu_reader_unregister(reader);
+}
+
+int main(void)
+{
+	struct hash_map_rcu *rcu = hash_map_rcu_create(struct setting*);
+	hash_map_rcu_set_on_key_removal(rcu, setting_free);
+	char key[32];
+	int created = 0;
+
+	//unpublished changes are only visible to the writer
+	struct setting *s = setting_new(0, 0);
+	++created;
+	int exists = hash_map_rcu_insert(rcu, "setting0", s);
+	int exists_again = hash_map_rcu_insert(rcu, "setting0", s);
+	assert(!exists && exists_again == 1);
+	struct hash_map_rcu_reader *reader = hash_map_rcu_reader_register(rcu);
+	struct hash_map *snapshot = hash_map_rcu_read_begin(rcu, reader);
+	assert(!hash_map_find(snapshot, "setting0") && hash_map_rcu_find(rcu, "setting0"));
+	hash_map_rcu_read_end(reader);
+	hash_map_rcu_publish(rcu);
+
+	//an old snapshot keeps its values alive until the read ends
+	snapshot = hash_map_rcu_read_begin(rcu, reader);
+	struct setting **old = hash_map_find(snapshot, "setting0");
+	s = setting_new(0, 1);
+	++created;
+	int replaced = hash_map_rcu_set(rcu, "setting0", s);
+	assert(replaced == 1);
+	hash_map_rcu_publish(rcu);
+	assert((*old)->magic == 0x5e771 && (*old)->version == 0);
+	assert(atomic_load(&finalized) == 0);
+	hash_map_rcu_read_end(reader);
+	hash_map_rcu_reclaim(rcu);
+	assert(atomic_load(&finalized) == 1);
+	hash_map_rcu_reader_unregister(reader);
+
+	thread_t threads[NUM_READERS];
+	for(int i = 0; i < NUM_READERS; ++i)
+	{
+		int failed = thread_create(&threads[i], reader_thread, rcu);
+		assert(!failed);
+	}
+
+	//a few hundred versions, growing the map, replacing and removing values
+	for(int version = 1; version <= 300; ++version)
+	{
+		for(int k = 0; k < 16; ++k)
+		{
+			int i = (version * 31 + k * 17) % NUM_KEYS;
+			snprintf(key, sizeof(key), "setting%d", i);
+			if(k == 15 && hash_map_rcu_remove_key(rcu, key))
+				continue;
+			s = setting_new(i, version);
+			++created;
+			hash_map_rcu_set(rcu, key, s);
+		}
+		hash_map_rcu_publish(rcu);
+	}
+	atomic_store(&stop, 1);
+	for(int i = 0; i < NUM_READERS; ++i)
+		thread_join(threads[i]);
+
+	hash_map_rcu_synchronize(rcu);
+	struct hash_map *current = atomic_load(&rcu->current);
+	printf("%zu publishes, %zu entries, %zu buckets, %d values finalized, %zu retired left\n",
+		rcu->num_publishes, current->num_entries, current->bucket_size, atomic_load(&finalized), array_size(rcu->retired));
+	assert(array_size(rcu->retired) == 0);
+	assert(created - atomic_load(&finalized) == (int)current->num_entries);
+
+	hash_map_rcu_destroy(&rcu);
+	assert(created == atomic_load(&finalized));
+	return 0;
+}
@@ -1,5 +1,6 @@
 #define HASH_MAP_IMPL
 #include "../hash_map.h"
+#include <assert.h>
 
 static void on_remove_value(char **p)
 {
@@ -41,8 +42,219 @@ void example_int()
 	hash_map_destroy(&hm);
 }
 
+void example_stats()
+{
+	struct hash_map *hm = hash_map_create(int);
+	char key[32];
+	for(int i = 0; i < 1000; ++i)
+	{
+		snprintf(key, sizeof(key), "key%d", i);
+		hash_map_insert(hm, key, i);
+	}
+	hash_map_find(hm, "key10");
+	hash_map_find(hm, "missing");
+	hash_map_find_n(hm, "key11 and more", 5);
+	
+	struct hash_map_stats stats;
+	hash_map_stats(hm, &stats);
+	printf("%zu entries, %zu buckets, longest chain %zu, %zu bytes\n", stats.entries, stats.bucket_count, stats.longest_chain, stats.total_bytes);
+	assert(stats.entries == 1000);
+	assert(stats.bucket_count == hm->bucket_size);
+	assert(stats.longest_chain >= 1);
+#ifdef HASH_MAP_COUNTERS
+	//find_n counts as a find too
+	assert(hm->counters.find.calls == 3 && hm->counters.find.hits == 2 && hm->counters.find.misses == 1);
+#endif
+	hash_map_dump(hm);
+	
+	hash_map_destroy(&hm);
+}
+
+void example_dense()
+{
+	struct hash_map *hm = hash_map_create_dense(int);
+	char key[32];
+	for(int i = 0; i < 1000; ++i)
+	{
+		snprintf(key, sizeof(key), "key%d", i);
+		hash_map_insert(hm, key, i);
+	}
+	for(int i = 0; i < 1000; i += 3)
+	{
+		snprintf(key, sizeof(key), "key%d", i);
+		hash_map_remove_key(&hm, key);
+	}
+	int *v = hash_map_find(hm, "key10");
+	assert(v && *v == 10);
+	assert(!hash_map_find(hm, "key9"));
+	assert(hash_map_find_n(hm, "key100x", 6));
+	(void)v;
+	
+	//insertion order
+	int prev = -1, count = 0;
+	hash_map_foreach_entry(hm, entry,
+	{
+		int value = *(int*)entry->data;
+		assert(value > prev && value % 3 != 0);
+		prev = value;
+		++count;
+	});
+	printf("%d entries in insertion order\n", count);
+	assert(count == 666 && hm->num_entries == 666);
+	(void)prev;
+	hash_map_dump(hm);
+	
+	hash_map_destroy(&hm);
+}
+
+void example_batch()
+{
+	enum { N = 10000 };
+	static char storage[N][16];
+	static const char *keys[N + 2];
+	static int values[N + 2];
+	for(int i = 0; i < N; ++i)
+	{
+		snprintf(storage[i], sizeof(storage[i]), "key%d", i);
+		keys[i] = storage[i];
+		values[i] = i;
+	}
+	keys[N] = "key5"; //duplicates, the first one wins
+	values[N] = -1;
+	keys[N + 1] = "key5";
+	values[N + 1] = -2;
+	
+	for(int dense = 0; dense < 2; ++dense)
+	{
+		struct hash_map *hm = dense ? hash_map_create_dense(int) : hash_map_create_with_capacity(int, 100);
+		hash_map_insert(hm, "key7", (int){ 700 });
+		size_t inserted = hash_map_insert_batch(hm, keys, values, N + 2, 0);
+		int *v5 = hash_map_find(hm, "key5"), *v7 = hash_map_find(hm, "key7");
+		printf("%s: inserted %zu of %d, key5 = %d, key7 = %d, %zu rehashes\n", dense ? "dense" : "chained", inserted, N + 2, *v5, *v7, hm->num_rehashes);
+		//key7 was already there and both key5 duplicates lose
+		assert(inserted == N - 1);
+		assert(*v5 == 5 && *v7 == 700);
+		assert(hm->num_entries == N);
+		hash_map_destroy(&hm);
+	}
+	
+	struct hash_map *hm = hash_map_create(int);
+	hash_map_reserve(hm, N);
+	size_t buckets = hm->bucket_size;
+	size_t inserted = hash_map_insert_batch(hm, keys, values, N, HASH_MAP_BATCH_UNIQUE);
+	int *v = hash_map_find(hm, "key9999");
+	//reserved up front, so no rehash
+	assert(hm->bucket_size == buckets);
+	assert(inserted == N && hm->num_entries == N);
+	assert(v && *v == 9999);
+	(void)inserted;
+	(void)v;
+	(void)buckets;
+	hash_map_destroy(&hm);
+}
+
+void example_shrink()
+{
+	char key[32];
+	struct hash_map *hm = hash_map_create(int);
+	hash_map_set_incremental(hm, 8);
+	for(int i = 0; i < 100000; ++i)
+	{
+		snprintf(key, sizeof(key), "key%d", i);
+		hash_map_insert(hm, key, i);
+	}
+	size_t peak_buckets = hm->bucket_size;
+	//purge 99%, the buckets shrink on the way down
+	for(int i = 0; i < 100000; ++i)
+	{
+		if(i % 100 == 0)
+			continue;
+		snprintf(key, sizeof(key), "key%d", i);
+		hash_map_remove_key(&hm, key);
+	}
+	printf("%zu entries, buckets %zu -> %zu\n", hm->num_entries, peak_buckets, hm->bucket_size);
+	assert(hm->num_entries == 1000);
+	assert(hm->bucket_size < peak_buckets);
+	
+	//repack what's left into fresh memory a few buckets at a time
+	hash_map_compact(hm);
+	int steps = 0;
+	while(hash_map_compact_step(hm, 64))
+	{
+		int *v = hash_map_find(hm, "key500");
+		assert(v && *v == 500);
+		(void)v;
+		++steps;
+	}
+	printf("compacted in %d steps to %zu buckets\n", steps, hm->bucket_size);
+	assert(hm->num_entries == 1000 && hm->bucket_size < peak_buckets);
+	assert(hash_map_find(hm, "key99900") && !hash_map_find(hm, "key99901"));
+	
+	//turning incremental resizing off finishes a pending one
+	hash_map_compact(hm);
+	assert(hm->old_buckets != NULL);
+	hash_map_set_incremental(hm, 0);
+	assert(hm->old_buckets == NULL && hm->num_entries == 1000);
+	assert(hash_map_find(hm, "key500") && hash_map_find(hm, "key99900"));
+	hash_map_destroy(&hm);
+}
+
+void example_filter()
+{
+	char key[32];
+	for(int dense = 0; dense < 2; ++dense)
+	{
+		struct hash_map *hm = dense ? hash_map_create_dense(int) : hash_map_create(int);
+		hash_map_enable_filter(hm, HASH_MAP_FILTER_BITS_PER_KEY);
+		for(int i = 0; i < 20000; ++i)
+		{
+			snprintf(key, sizeof(key), "present%d", i);
+			hash_map_insert(hm, key, i);
+		}
+		//every present key has to get through, most missing ones shouldn't
+		for(int i = 0; i < 20000; ++i)
+		{
+			snprintf(key, sizeof(key), "present%d", i);
+			int *v = hash_map_find(hm, key);
+			assert(v && *v == i);
+			(void)v;
+		}
+		for(int i = 0; i < 100000; ++i)
+		{
+			snprintf(key, sizeof(key), "missing%d", i);
+			void *v = hash_map_find(hm, key);
+			assert(v == NULL);
+			(void)v;
+		}
+		struct hash_map_stats stats;
+		hash_map_stats(hm, &stats);
+		printf("%s: filter %zu bytes, %.2f%% false positives estimated\n", dense ? "dense" : "chained", stats.filter_bytes, stats.filter_fp_estimate * 100.0);
+		assert(stats.filter_fp_estimate > 0.0 && stats.filter_fp_estimate <= 0.03);
+#ifdef HASH_MAP_COUNTERS
+		//finds only count with HASH_MAP_COUNTERS, so a filtered map stays safe for concurrent readers without it
+		assert(stats.filter_negatives + stats.filter_false_positives == 100000);
+		assert(stats.filter_fp_observed <= 0.03);
+#endif
+		
+		//removing most keys rebuilds the filter without them
+		for(int i = 100; i < 20000; ++i)
+		{
+			snprintf(key, sizeof(key), "present%d", i);
+			hash_map_remove_key(&hm, key);
+		}
+		assert(hm->filter_keys <= 2 * hm->num_entries + HASH_BUCKET_SIZE);
+		assert(hash_map_find(hm, "present99") && !hash_map_find(hm, "present100"));
+		hash_map_destroy(&hm);
+	}
+}
+
 int main(void)
 {
 	example_heap_allocated_string();
 	example_int();
+	example_stats();
+	example_dense();
+	example_batch();
+	example_shrink();
+	example_filter();
 }
\ No newline at end of file
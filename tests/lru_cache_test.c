@@ -0,0 +1,220 @@
+#define LRU_CACHE_IMPL
+#include "../lru_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdatomic.h>
+
+#define NUM_THREADS (4)
+#define NUM_SHARED_KEYS (2000)
+
+static int num_released = 0;
+
+static void release(void *data)
+{
+	free(*(char**)data);
+	++num_released;
+}
+
+static void example_count_limit(void)
+{
+	struct lru_cache *cache = lru_cache_create(char*, 3, 0);
+	lru_cache_set_on_key_removal(cache, release);
+	const char *keys[] = { "a", "b", "c", "d" };
+	for(int i = 0; i < 3; ++i)
+	{
+		char *v = malloc(16);
+		snprintf(v, 16, "value%d", i);
+		int replaced = lru_cache_put(cache, keys[i], v);
+		assert(!replaced);
+		(void)replaced;
+	}
+	//"a" becomes the most recently used, so "b" is evicted next
+	char **a = lru_cache_get(cache, "a");
+	assert(a && !strcmp(*a, "value0"));
+	char *v = malloc(16);
+	snprintf(v, 16, "value3");
+	lru_cache_put(cache, "d", v);
+	assert(!lru_cache_peek(cache, "b") && lru_cache_peek(cache, "c"));
+	assert(cache->num_entries == 3 && num_released == 1);
+
+	//replacing releases the old value
+	v = malloc(16);
+	snprintf(v, 16, "new");
+	int replaced = lru_cache_put(cache, "c", v);
+	assert(replaced == 1 && num_released == 2);
+	char **b = lru_cache_get(cache, "b");
+	assert(!b);
+	int removed = lru_cache_remove_key(cache, "a");
+	int removed_again = lru_cache_remove_key(cache, "a");
+	assert(removed && !removed_again);
+	(void)a;
+	(void)replaced;
+	(void)b;
+	(void)removed;
+	(void)removed_again;
+
+	const char *order[] = { "d", "c" };
+	int n = 0;
+	lru_cache_foreach_entry(cache, entry,
+	{
+		assert(!strcmp(entry->key, order[n]));
+		++n;
+	});
+	assert(n == 2);
+	(void)order;
+
+	struct lru_cache_stats stats;
+	lru_cache_stats(cache, &stats);
+	printf("%zu entries, %zu hits, %zu misses, %zu evictions, %zu pooled\n", stats.entries, stats.hits, stats.misses, stats.evictions, stats.pooled_entries);
+	assert(stats.hits == 1 && stats.misses == 1 && stats.evictions == 1 && stats.pooled_entries == 4);
+	lru_cache_destroy(&cache);
+	assert(num_released == 5);
+}
+
+static void example_byte_limit(void)
+{
+	//values own 1000 bytes each, long keys are counted too
+	struct lru_cache *cache = lru_cache_create(int, 0, 100000);
+	char key[64];
+	for(int i = 0; i < 10000; ++i)
+	{
+		snprintf(key, sizeof(key), i % 2 ? "a key that is long enough not to fit in the node %d" : "%d", i);
+		lru_cache_put_bytes(cache, key, i, 1000);
+		assert(cache->bytes <= 100000);
+	}
+	printf("%zu entries in %zu bytes, %zu evictions, %zu buckets\n", cache->num_entries, cache->bytes, cache->evictions, cache->bucket_size);
+	assert(cache->num_entries > 80 && cache->num_entries < 100);
+	int *last = lru_cache_get(cache, "a key that is long enough not to fit in the node 9999");
+	assert(last && *last == 9999);
+	lru_cache_clear(cache);
+	int *cleared = lru_cache_get(cache, "9998");
+	assert(cache->num_entries == 0 && cache->bytes == 0 && !cleared);
+	(void)last;
+	(void)cleared;
+	lru_cache_destroy(&cache);
+}
+
+static void example_sharded(void)
+{
+	struct lru_cache_sharded *cache = lru_cache_sharded_create(int, 4, 1000, 0);
+	char key[32];
+	for(int i = 0; i < 5000; ++i)
+	{
+		snprintf(key, sizeof(key), "%d", i);
+		lru_cache_sharded_put(cache, key, i);
+	}
+	int v = 0;
+	int found = lru_cache_sharded_get(cache, "4999", v);
+	assert(found && v == 4999);
+	found = lru_cache_sharded_get(cache, "0", v);
+	assert(!found);
+	int removed = lru_cache_sharded_remove_key(cache, "4999");
+	assert(removed);
+	(void)found;
+	(void)removed;
+	struct lru_cache_stats stats;
+	lru_cache_sharded_stats(cache, &stats);
+	printf("sharded: %zu entries, %zu evictions\n", stats.entries, stats.evictions);
+	assert(stats.entries <= 1000 && stats.entries + stats.evictions == 4999);
+	lru_cache_sharded_destroy(&cache);
+}
+
+static atomic_int num_finalized = 0;
+
+static void count_finalized(void *data)
+{
+	(void)data;
+	atomic_fetch_add(&num_finalized, 1);
+}
+
+struct sharded_worker
+{
+	struct lru_cache_sharded *cache;
+	int id;
+	size_t inserted; //puts that added a key
+	size_t replaced;
+	size_t removed;
+	size_t gets;
+	size_t hits;
+};
+
+static void sharded_worker_thread(void *userptr)
+{
+	struct sharded_worker *w = userptr;
+	char key[32];
+	unsigned int seed = 1234 + w->id;
+	for(int i = 0; i < 50000; ++i)
+	{
+		//the keys are shared so threads meet in the same shards and entries
+		seed = seed * 1103515245 + 12345;
+		int k = (seed >> 8) % NUM_SHARED_KEYS;
+		snprintf(key, sizeof(key), "shared%d", k);
+		int op = (seed >> 4) % 8;
+		if(op < 4)
+		{
+			//values say which key they belong to, a get copying out anything else saw a torn or wrong entry
+			int v = k + NUM_SHARED_KEYS * w->id;
+			if(lru_cache_sharded_put(w->cache, key, v))
+				++w->replaced;
+			else
+				++w->inserted;
+		} else if(op < 7)
+		{
+			int v = -1;
+			++w->gets;
+			if(lru_cache_sharded_get(w->cache, key, v))
+			{
+				assert(v % NUM_SHARED_KEYS == k);
+				++w->hits;
+			}
+		} else if(lru_cache_sharded_remove_key(w->cache, key))
+			++w->removed;
+	}
+}
+
+static void example_sharded_threads(void)
+{
+	struct lru_cache_sharded *cache = lru_cache_sharded_create(int, 8, 1000, 0);
+	lru_cache_sharded_set_on_key_removal(cache, count_finalized);
+	struct sharded_worker workers[NUM_THREADS];
+	thread_t threads[NUM_THREADS];
+	for(int i = 0; i < NUM_THREADS; ++i)
+	{
+		workers[i] = (struct sharded_worker){ .cache = cache, .id = i };
+		int failed = thread_create(&threads[i], sharded_worker_thread, &workers[i]);
+		assert(!failed);
+		(void)failed;
+	}
+	struct sharded_worker total = {0};
+	for(int i = 0; i < NUM_THREADS; ++i)
+	{
+		thread_join(threads[i]);
+		total.inserted += workers[i].inserted;
+		total.replaced += workers[i].replaced;
+		total.removed += workers[i].removed;
+		total.gets += workers[i].gets;
+		total.hits += workers[i].hits;
+	}
+
+	//every key added is still there, was evicted or was removed, and every value that left was finalized
+	struct lru_cache_stats stats;
+	lru_cache_sharded_stats(cache, &stats);
+	printf("%d threads: %zu entries, %zu evictions, %zu inserted, %zu removed, %zu of %zu gets hit\n",
+		NUM_THREADS, stats.entries, stats.evictions, total.inserted, total.removed, total.hits, total.gets);
+	assert(stats.entries + stats.evictions + total.removed == total.inserted);
+	assert(stats.hits == total.hits && stats.hits + stats.misses == total.gets);
+	assert(stats.entries <= 1000);
+	assert((size_t)atomic_load(&num_finalized) == stats.evictions + total.removed + total.replaced);
+	lru_cache_sharded_destroy(&cache);
+	assert((size_t)atomic_load(&num_finalized) == total.inserted + total.replaced);
+}
+
+int main(void)
+{
+	example_count_limit();
+	example_byte_limit();
+	example_sharded();
+	example_sharded_threads();
+	return 0;
+}
@@ -0,0 +1,56 @@
+#define MEMORY_TRACKING
+#define MEMORY_IMPL
+#define HASH_MAP_IMPL
+#define LINKED_LIST_IMPL
+#define HEAP_STRING_IMPL
+#include "../hash_map.h"
+#include "../linked_list.h"
+#include "../heap_string.h"
+
+static struct memory_tag map_tag, list_tag;
+
+int main(void)
+{
+	memory_tag_init(&map_tag, "hash_map");
+	memory_tag_init(&list_tag, "linked_list");
+	//already registered, doesn't reset it or loop the list
+	memory_tag_init(&list_tag, "linked_list");
+	
+	struct hash_map *hm = hash_map_create_with_custom_allocator(int, &map_tag, memory_tracking_allocate);
+	struct linked_list *list = linked_list_create_with_custom_allocator(int, &list_tag, memory_tracking_allocate);
+	heap_string s = heap_string_new("counted as default");
+	
+	char key[32];
+	for(int i = 0; i < 1000; ++i)
+	{
+		snprintf(key, sizeof(key), "%d", i);
+		hash_map_insert(hm, key, i);
+		linked_list_prepend(list, i);
+	}
+	
+	struct memory_tag_stats stats;
+	memory_tag_stats(&list_tag, &stats);
+	printf("list: %lld bytes live, %lld allocations\n", stats.live_bytes, stats.live_allocations);
+	assert(stats.live_allocations == 1001);
+	assert(stats.live_bytes == (long long)(sizeof(struct linked_list) + 1000 * (sizeof(struct linked_list_node) + sizeof(int))));
+	
+	memory_tracking_dump();
+	
+	hash_map_destroy(&hm);
+	linked_list_destroy(&list);
+	heap_string_free(&s);
+	
+	memory_tag_stats(&map_tag, &stats);
+	assert(stats.live_bytes == 0 && stats.live_allocations == 0);
+	assert(stats.peak_bytes > 0);
+	memory_tag_stats(&memory_tag_default, &stats);
+	assert(stats.live_bytes == 0 && stats.allocations == 1);
+	memory_tag_destroy(&list_tag);
+	memory_tracking_dump(); //hash_map and default left
+	memory_tag_destroy(&map_tag);
+	memory_tag_init(&map_tag, "hash_map again");
+	memory_tag_stats(&map_tag, &stats);
+	assert(stats.allocations == 0);
+	memory_tag_destroy(&map_tag);
+	return 0;
+}
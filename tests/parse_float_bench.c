@@ -0,0 +1,136 @@
+#define PARSE_IMPL
+#define HEAP_STRING_IMPL
+#include "../parse.h"
+#include <time.h>
+
+//gcc -O2 parse_float_bench.c && ./a.out [num_vertices]
+
+//parse_float as it was before, kept for comparison (buffer is zeroed so atof sees a terminated string)
+static int parse_float_atof(FILE *fp, float* out)
+{
+	int c;
+	char string[128] = {0};
+	size_t stringindex = 0;
+	do
+	{
+		if(stringindex >= sizeof(string))
+			return 1;
+		c = fgetc(fp);
+		string[stringindex++ % sizeof(string)] = c;
+	} while(c != EOF && ( c == 'e' || isdigit(c) || c == '-' || c == '.' ));
+	*out = (float)atof(string);
+	ungetc(c, fp);
+	return c == EOF ? 1 : 0;
+}
+
+static int parse_float3_atof(FILE *fp, float *v)
+{
+	for(int i = 0; i < 3; ++i)
+	{
+		parse_whitespace(fp);
+		if(parse_float_atof(fp, &v[i]))
+			return 1;
+	}
+	parse_whitespace(fp);
+	return 0;
+}
+
+static double now_seconds(void)
+{
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double run(FILE *fp, int use_atof, size_t *num_floats, float *checksum)
+{
+	char ident[16];
+	float v[3];
+	*num_floats = 0;
+	*checksum = 0.f;
+	rewind(fp);
+	double start = now_seconds();
+	for(;;)
+	{
+		if(parse_ident_to_buffer(fp, ident, sizeof(ident), NULL))
+			break;
+		if(!strcmp(ident, "v"))
+		{
+			if(use_atof ? parse_float3_atof(fp, v) : parse_float3(fp, v))
+				break;
+			*checksum += v[0] + v[1] + v[2];
+			*num_floats += 3;
+		}
+		parse_skip_line(fp);
+	}
+	return now_seconds() - start;
+}
+
+//conversion only, the file is in memory and the tokens are already split
+static double run_buffer(const char *buf, size_t len, int use_strtof, size_t *num_floats, float *checksum)
+{
+	const char *p = buf;
+	const char *end = buf + len;
+	*num_floats = 0;
+	*checksum = 0.f;
+	double start = now_seconds();
+	while(p < end)
+	{
+		while(p < end && (*p == ' ' || *p == '\n' || *p == 'v' || *p == 'n'))
+			++p;
+		if(p >= end)
+			break;
+		float f;
+		if(use_strtof)
+		{
+			char *e;
+			f = strtof(p, &e);
+			p = e;
+		} else
+			p += parse_float_from_buffer(p, end - p, &f);
+		*checksum += f;
+		++*num_floats;
+	}
+	return now_seconds() - start;
+}
+
+int main(int argc, char **argv)
+{
+	size_t num_vertices = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+	
+	FILE *fp = tmpfile();
+	if(!fp)
+		return 1;
+	srand(42);
+	for(size_t i = 0; i < num_vertices; ++i)
+	{
+		fprintf(fp, "v %f %f %f\n",
+			(rand() / (float)RAND_MAX) * 200.f - 100.f,
+			(rand() / (float)RAND_MAX) * 2.f - 1.f,
+			(rand() / (float)RAND_MAX) * 1e4f);
+		if(i % 8 == 0)
+			fprintf(fp, "vn %g %g %g\n", rand() / (float)RAND_MAX, -0.5f, 1e-3f);
+	}
+	
+	size_t n;
+	float checksum;
+	double t_atof = run(fp, 1, &n, &checksum);
+	printf("atof:        %zu floats in %.3fs, %.2f Mfloats/s (checksum %f)\n", n, t_atof, n / t_atof / 1e6, checksum);
+	double t_fast = run(fp, 0, &n, &checksum);
+	printf("parse_float: %zu floats in %.3fs, %.2f Mfloats/s (checksum %f)\n", n, t_fast, n / t_fast / 1e6, checksum);
+	printf("speedup %.2fx\n", t_atof / t_fast);
+	
+	long len = ftell(fp);
+	char *buf = malloc(len + 1);
+	rewind(fp);
+	fread(buf, 1, len, fp);
+	buf[len] = '\0';
+	double t_strtof = run_buffer(buf, len, 1, &n, &checksum);
+	printf("buffer strtof:                  %zu floats in %.3fs, %.2f Mfloats/s (checksum %f)\n", n, t_strtof, n / t_strtof / 1e6, checksum);
+	double t_buffer = run_buffer(buf, len, 0, &n, &checksum);
+	printf("buffer parse_float_from_buffer: %zu floats in %.3fs, %.2f Mfloats/s (checksum %f)\n", n, t_buffer, n / t_buffer / 1e6, checksum);
+	printf("speedup %.2fx\n", t_strtof / t_buffer);
+	free(buf);
+	fclose(fp);
+	return 0;
+}
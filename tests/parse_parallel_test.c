@@ -0,0 +1,94 @@
+#define PARSE_IMPL
+#define PARSE_PARALLEL_IMPL
+#define HEAP_STRING_IMPL
+#include "../parse_parallel.h"
+#include <assert.h>
+
+struct vertices
+{
+	float *v;
+	size_t count;
+	size_t capacity;
+};
+
+static void vertices_push(struct vertices *vs, float *v)
+{
+	if(vs->count + 3 > vs->capacity)
+	{
+		vs->capacity = vs->capacity ? vs->capacity * 2 : 96;
+		vs->v = realloc(vs->v, sizeof(float) * vs->capacity);
+	}
+	memcpy(&vs->v[vs->count], v, sizeof(float) * 3);
+	vs->count += 3;
+}
+
+static void *on_chunk_begin(void *userptr, size_t chunk_index)
+{
+	(void)userptr;
+	(void)chunk_index;
+	return calloc(1, sizeof(struct vertices));
+}
+
+static int on_line(void *state, struct parse_buffer *line)
+{
+	char ident[16];
+	float v[3];
+	if(parse_buffer_ident_to_buffer(line, ident, sizeof(ident), NULL))
+		return 0;
+	if(strcmp(ident, "v"))
+		return 0;
+	if(parse_buffer_float3(line, v))
+		return 1;
+	vertices_push(state, v);
+	return 0;
+}
+
+static void on_chunk_end(void *userptr, size_t chunk_index, void *state)
+{
+	(void)chunk_index;
+	struct vertices *vs = state;
+	for(size_t i = 0; i < vs->count; i += 3)
+		vertices_push(userptr, &vs->v[i]);
+	free(vs->v);
+	free(vs);
+}
+
+int main(void)
+{
+	const char *filename = "parse_parallel_test.obj";
+	FILE *fp = fopen(filename, "w");
+	assert(fp);
+	fprintf(fp, "# generated\n");
+	for(int i = 0; i < 100000; ++i)
+	{
+		fprintf(fp, "v %d.5 %d -%d.25\r\n", i, i + 1, i + 2);
+		if(i % 7 == 0)
+			fprintf(fp, "\n# comment\nvn 0 1 0\n");
+	}
+	fprintf(fp, "v 1 2 3"); //no trailing newline
+	fclose(fp);
+	
+	struct vertices vs = {0};
+	int result = parse_parallel_file(filename, 4, on_chunk_begin, on_line, on_chunk_end, &vs);
+	assert(result == 0);
+	assert(vs.count == 3 * 100001);
+	for(int i = 0; i < 100000; ++i)
+	{
+		assert(vs.v[i * 3] == i + 0.5f);
+		assert(vs.v[i * 3 + 1] == i + 1);
+		assert(vs.v[i * 3 + 2] == -(i + 2.25f));
+	}
+	assert(vs.v[300002] == 3.f);
+	free(vs.v);
+	
+	//a malformed line stops the parse
+	static const char bad[] = "v 1 2 3\nv 1 x 3\nv 4 5 6\n";
+	memset(&vs, 0, sizeof(vs));
+	result = parse_parallel_buffer(bad, sizeof(bad) - 1, 2, on_chunk_begin, on_line, on_chunk_end, &vs);
+	assert(result == 1);
+	free(vs.v);
+	
+	remove(filename);
+	printf("parse_parallel tests passed\n");
+	return 0;
+}
@@ -0,0 +1,77 @@
+#define PARSE_IMPL
+#define PARSE_STREAM_IMPL
+#define HEAP_STRING_IMPL
+#include "../parse_stream.h"
+#include <assert.h>
+
+//feeding in pieces has to give the same tokens as parse_buffer_token on the whole input
+static void check(const char *input, size_t n, size_t max_piece)
+{
+	struct parse_stream ps;
+	parse_stream_init(&ps);
+	
+	struct parse_buffer pb;
+	parse_buffer_init(&pb, input, n);
+	
+	size_t offset = 0;
+	size_t num_checked = 0;
+	for(;;)
+	{
+		size_t piece = 1 + rand() % max_piece;
+		if(offset + piece > n)
+			piece = n - offset;
+		if(piece)
+			parse_stream_feed(&ps, input + offset, piece);
+		else
+			parse_stream_finish(&ps);
+		offset += piece;
+		
+		size_t count;
+		struct parse_token *tokens = parse_stream_tokens(&ps, &count);
+		for(size_t i = 0; i < count; ++i)
+		{
+			struct parse_slice expected;
+			int type = parse_buffer_token(&pb, &expected);
+			const char *text = parse_stream_token_text(&ps, &tokens[i]);
+			if(type != tokens[i].type || !parse_slice_equals(&expected, text))
+			{
+				printf("token %zu: expected '%.*s' got '%s'\n", num_checked, (int)expected.len, expected.ptr, text);
+				assert(0);
+			}
+			if(type == PARSE_TOKEN_NUMBER)
+			{
+				double d;
+				parse_double_from_buffer(expected.ptr, expected.len, &d);
+				assert(d == tokens[i].number);
+			}
+			++num_checked;
+		}
+		parse_stream_clear(&ps);
+		if(!piece)
+			break;
+	}
+	struct parse_slice rest;
+	int token = parse_buffer_token(&pb, &rest);
+	assert(token == PARSE_TOKEN_NONE);
+	parse_stream_free(&ps);
+}
+
+int main(void)
+{
+	static const char config[] = "set width -3.5e2\nbind x +1 ;\r\nname=\"abc_12\" 1.2.3 1e 1e+ -. ..5 -x\n";
+	for(size_t piece = 1; piece < 8; ++piece)
+		check(config, sizeof(config) - 1, piece);
+	
+	static const char alphabet[] = "ab_9081.eE+- \t\n=;";
+	char buf[512];
+	srand(7);
+	for(int round = 0; round < 2000; ++round)
+	{
+		size_t n = rand() % sizeof(buf);
+		for(size_t i = 0; i < n; ++i)
+			buf[i] = alphabet[rand() % (sizeof(alphabet) - 1)];
+		check(buf, n, 1 + rand() % 64);
+	}
+	printf("parse_stream tests passed\n");
+	return 0;
+}
@@ -0,0 +1,138 @@
+#define PARSE_IMPL
+#define HEAP_STRING_IMPL
+#define HASH_MAP_IMPL
+#include "../parse.h"
+#include "../hash_map.h"
+#include <assert.h>
+
+static void test_against_strtod(void)
+{
+	char buf[64];
+	srand(1234);
+	for(int i = 0; i < 100000; ++i)
+	{
+		int digits = 1 + rand() % 20;
+		int point = rand() % (digits + 1);
+		size_t n = 0;
+		if(rand() & 1)
+			buf[n++] = '-';
+		for(int k = 0; k < digits; ++k)
+		{
+			if(k == point)
+				buf[n++] = '.';
+			buf[n++] = '0' + rand() % 10;
+		}
+		if(rand() % 4 == 0)
+			n += sprintf(&buf[n], "e%d", rand() % 80 - 40);
+		buf[n] = '\0';
+		
+		double d;
+		float f;
+		size_t used_d = parse_double_from_buffer(buf, n, &d);
+		size_t used_f = parse_float_from_buffer(buf, n, &f);
+		assert(used_d == n && used_f == n);
+		if(d != strtod(buf, NULL) || f != strtof(buf, NULL))
+		{
+			printf("mismatch for '%s'\n", buf);
+			assert(0);
+		}
+	}
+}
+
+static void test_scanners(void)
+{
+	static const char alphabet[] = "  \t\t\n\r\vab_1.";
+	char buf[300];
+	for(int round = 0; round < 2000; ++round)
+	{
+		size_t n = rand() % sizeof(buf);
+		for(size_t i = 0; i < n; ++i)
+			buf[i] = alphabet[rand() % (sizeof(alphabet) - 1)];
+		//long runs so the vector loops get exercised
+		size_t run = rand() % (n + 1);
+		memset(buf, " a\t"[round % 3], run);
+		
+		const char *end = buf + n;
+		assert(parse_scan_blank(buf, end) == parse_scan_blank_scalar(buf, end));
+		assert(parse_scan_newline(buf, end) == parse_scan_newline_scalar(buf, end));
+		assert(parse_scan_ident_end(buf, end) == parse_scan_ident_end_scalar(buf, end));
+#ifdef PARSE_SIMD_X86
+		assert(parse_scan_blank_sse2(buf, end) == parse_scan_blank_scalar(buf, end));
+		assert(parse_scan_newline_sse2(buf, end) == parse_scan_newline_scalar(buf, end));
+		assert(parse_scan_ident_end_sse2(buf, end) == parse_scan_ident_end_scalar(buf, end));
+#endif
+	}
+}
+
+static void test_slices(void)
+{
+	static const char input[] = "vn  0.5 -1 .25\nset width=-3e2; a-b\n";
+	struct parse_buffer pb;
+	struct parse_slice slice;
+	parse_buffer_init(&pb, input, sizeof(input) - 1);
+	
+	int r = parse_buffer_ident(&pb, &slice);
+	assert(!r);
+	assert(slice.ptr == input && parse_slice_equals(&slice, "vn"));
+	
+	//the slice can be looked up without copying it
+	struct hash_map *hm = hash_map_create(int);
+	hash_map_insert(hm, "vn", (int){ 7 });
+	int *found = hash_map_find_n(hm, slice.ptr, slice.len);
+	assert(found && *found == 7);
+	assert(!hash_map_find_n(hm, slice.ptr, 1));
+	hash_map_destroy(&hm);
+	
+	static const int expected[] = {
+		PARSE_TOKEN_NUMBER, PARSE_TOKEN_NUMBER, PARSE_TOKEN_NUMBER, PARSE_TOKEN_NEWLINE,
+		PARSE_TOKEN_IDENT, PARSE_TOKEN_IDENT, PARSE_TOKEN_PUNCT, PARSE_TOKEN_NUMBER, PARSE_TOKEN_PUNCT,
+		PARSE_TOKEN_IDENT, PARSE_TOKEN_PUNCT, PARSE_TOKEN_IDENT, PARSE_TOKEN_NEWLINE, PARSE_TOKEN_NONE
+	};
+	static const char *text[] = { "0.5", "-1", ".25", "\n", "set", "width", "=", "-3e2", ";", "a", "-", "b", "\n", "" };
+	for(size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); ++i)
+	{
+		int token = parse_buffer_token(&pb, &slice);
+		assert(token == expected[i]);
+		assert(parse_slice_equals(&slice, text[i]));
+	}
+}
+
+static void test_file(void)
+{
+	FILE *fp = tmpfile();
+	fputs("v 1.5 -2.25e+1 .5\nv 1-2.e 0 0\n", fp);
+	for(int i = 0; i < 600; ++i)
+		fputc('#', fp);
+	fputs("\nlast", fp);
+	rewind(fp);
+	
+	char ident[16];
+	float v[3];
+	parse_ident_to_buffer(fp, ident, sizeof(ident), NULL);
+	assert(!strcmp(ident, "v"));
+	int r = parse_float3(fp, v);
+	assert(!r);
+	assert(v[0] == 1.5f && v[1] == -22.5f && v[2] == 0.5f);
+	parse_skip_line(fp);
+	
+	parse_ident_to_buffer(fp, ident, sizeof(ident), NULL);
+	parse_whitespace(fp);
+	r = parse_float(fp, &v[0]);
+	assert(r == 1); //malformed
+	parse_skip_line(fp);
+	parse_skip_line(fp);
+	r = parse_ident_to_buffer(fp, ident, sizeof(ident), NULL);
+	assert(r == 1); //EOF
+	assert(!strcmp(ident, "last"));
+	fclose(fp);
+}
+
+int main(void)
+{
+	test_against_strtod();
+	test_scanners();
+	test_slices();
+	test_file();
+	printf("parse tests passed\n");
+	return 0;
+}
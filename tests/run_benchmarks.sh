@@ -0,0 +1,12 @@
+#!/bin/bash
+
+# ./run_benchmarks.sh [bench options], e.g --max-size 10000000 or --filter hash_map
+# the first run stores bench_baseline.csv, later runs are compared against it
+# (delete it or copy bench_results.csv over it to accept new numbers)
+
+gcc -O2 -pthread bench.c -o bench || exit 1
+if [ -f bench_baseline.csv ]; then
+	./bench --baseline bench_baseline.csv --csv bench_results.csv --json bench_results.json "$@"
+else
+	./bench --save-baseline bench_baseline.csv --csv bench_results.csv --json bench_results.json "$@"
+fi
@@ -5,4 +5,26 @@ valgrind --leak-check=yes ./a.out
 gcc -g hash_map_test2.c
 valgrind --leak-check=yes ./a.out
 gcc -g heap_string_test.c
-valgrind --leak-check=yes ./a.out
\ No newline at end of file
+valgrind --leak-check=yes ./a.out
+gcc -g parse_test.c
+valgrind --leak-check=yes ./a.out
+gcc -g parse_parallel_test.c -pthread
+valgrind --leak-check=yes ./a.out
+gcc -g parse_stream_test.c
+valgrind --leak-check=yes ./a.out
+gcc -g memory_test.c
+valgrind --leak-check=yes ./a.out
+gcc -g template_test.c
+valgrind --leak-check=yes ./a.out
+gcc -g hash_map_pod_test.c
+valgrind --leak-check=yes ./a.out
+gcc -g array_test.c
+valgrind --leak-check=yes ./a.out
+gcc -g hash_map_parallel_test.c -pthread
+valgrind --leak-check=yes ./a.out
+gcc -g hash_map_rcu_test.c -pthread
+valgrind --leak-check=yes ./a.out
+gcc -g lru_cache_test.c -pthread
+valgrind --leak-check=yes ./a.out
+gcc -g art_test.c
+valgrind --leak-check=yes ./a.out
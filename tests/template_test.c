@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+struct vec3
+{
+	float x, y, z;
+};
+
+static int strings_freed = 0;
+
+static void free_string(char **s)
+{
+	free(*s);
+	++strings_freed;
+}
+
+#define HASH_MAP_TEMPLATE_NAME vec3_map
+#define HASH_MAP_TEMPLATE_TYPE struct vec3
+#include "../hash_map_template.h"
+
+#define HASH_MAP_TEMPLATE_NAME string_map
+#define HASH_MAP_TEMPLATE_TYPE char*
+#define HASH_MAP_TEMPLATE_FINALIZER free_string
+#include "../hash_map_template.h"
+
+#define LINKED_LIST_TEMPLATE_NAME int_list
+#define LINKED_LIST_TEMPLATE_TYPE int
+#include "../linked_list_template.h"
+
+static void example_map(void)
+{
+	struct vec3_map *m = vec3_map_create();
+	char key[32];
+	for(int i = 0; i < 1000; ++i)
+	{
+		snprintf(key, sizeof(key), "v%d", i);
+		int exists = vec3_map_insert(m, key, (struct vec3){ i, i * 2, i * 3 });
+		assert(!exists);
+	}
+	int exists = vec3_map_insert(m, "v10", (struct vec3){ 0 });
+	assert(exists == 1);
+	assert(m->num_entries == 1000);
+	
+	struct vec3 *v = vec3_map_find(m, "v10");
+	assert(v && v->x == 10 && v->z == 30);
+	assert(!vec3_map_find(m, "v1000"));
+	
+	int removed = vec3_map_remove_key(m, "v10");
+	int removed_again = vec3_map_remove_key(m, "v10");
+	assert(removed && !removed_again);
+	assert(!vec3_map_find(m, "v10"));
+	
+	int count = 0;
+	hash_map_template_foreach_entry(vec3_map, m, entry,
+	{
+		assert(entry->value.y == entry->value.x * 2);
+		++count;
+	});
+	assert(count == 999);
+	vec3_map_destroy(&m);
+	assert(!m);
+	
+	struct string_map *sm = string_map_create();
+	string_map_insert(sm, "a", strdup("hello"));
+	string_map_insert(sm, "b", strdup("world"));
+	printf("%s %s\n", *string_map_find(sm, "a"), *string_map_find(sm, "b"));
+	string_map_remove_key(sm, "a");
+	assert(strings_freed == 1);
+	string_map_destroy(&sm);
+	assert(strings_freed == 2);
+}
+
+static void example_list(void)
+{
+	struct int_list *l = int_list_create();
+	for(int i = 0; i < 10; ++i)
+		int_list_append(l, i);
+	int_list_prepend(l, -1);
+	
+	int expected = -1;
+	linked_list_template_foreach(int_list, l, node,
+	{
+		assert(node->value == expected);
+		++expected;
+		if(node->value % 2)
+			int_list_erase_node(l, node);
+	});
+	assert(l->head->value == 0 && l->tail->value == 8);
+	
+	expected = 8;
+	linked_list_template_reversed_foreach(int_list, l, node,
+	{
+		assert(node->value == expected);
+		expected -= 2;
+	});
+	int_list_destroy(&l);
+	assert(!l);
+}
+
+int main(void)
+{
+	example_map();
+	example_list();
+	return 0;
+}
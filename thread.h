@@ -0,0 +1,128 @@
+#ifndef RHD_THREAD_H
+#define RHD_THREAD_H
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <process.h>
+typedef HANDLE thread_t;
+typedef SRWLOCK thread_mutex_t;
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+typedef pthread_t thread_t;
+typedef pthread_mutex_t thread_mutex_t;
+#endif
+
+typedef void (*thread_fn_t)(void *userptr);
+
+struct thread_start_
+{
+	thread_fn_t fn;
+	void *userptr;
+};
+
+#ifdef _WIN32
+static unsigned __stdcall thread_start_trampoline_(void *p)
+#else
+static void *thread_start_trampoline_(void *p)
+#endif
+{
+	struct thread_start_ start = *(struct thread_start_*)p;
+	free(p);
+	start.fn(start.userptr);
+	return 0;
+}
+
+//returns 0 on success
+static int thread_create(thread_t *t, thread_fn_t fn, void *userptr)
+{
+	struct thread_start_ *start = malloc(sizeof(struct thread_start_));
+	if(!start)
+		return 1;
+	start->fn = fn;
+	start->userptr = userptr;
+	#ifdef _WIN32
+		*t = (HANDLE)_beginthreadex(NULL, 0, thread_start_trampoline_, start, 0, NULL);
+		if(*t)
+			return 0;
+	#else
+		if(!pthread_create(t, NULL, thread_start_trampoline_, start))
+			return 0;
+	#endif
+	free(start);
+	return 1;
+}
+
+static void thread_join(thread_t t)
+{
+	#ifdef _WIN32
+		WaitForSingleObject(t, INFINITE);
+		CloseHandle(t);
+	#else
+		pthread_join(t, NULL);
+	#endif
+}
+
+static void thread_yield(void)
+{
+	#ifdef _WIN32
+		SwitchToThread();
+	#else
+		sched_yield();
+	#endif
+}
+
+static int thread_hardware_concurrency(void)
+{
+	#ifdef _WIN32
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return (int)info.dwNumberOfProcessors;
+	#else
+		long n = sysconf(_SC_NPROCESSORS_ONLN);
+		return n > 0 ? (int)n : 1;
+	#endif
+}
+
+static void thread_mutex_init(thread_mutex_t *m)
+{
+	#ifdef _WIN32
+		InitializeSRWLock(m);
+	#else
+		pthread_mutex_init(m, NULL);
+	#endif
+}
+
+static void thread_mutex_destroy(thread_mutex_t *m)
+{
+	#ifdef _WIN32
+		(void)m;
+	#else
+		pthread_mutex_destroy(m);
+	#endif
+}
+
+static void thread_mutex_lock(thread_mutex_t *m)
+{
+	#ifdef _WIN32
+		AcquireSRWLockExclusive(m);
+	#else
+		pthread_mutex_lock(m);
+	#endif
+}
+
+static void thread_mutex_unlock(thread_mutex_t *m)
+{
+	#ifdef _WIN32
+		ReleaseSRWLockExclusive(m);
+	#else
+		pthread_mutex_unlock(m);
+	#endif
+}
+#endif